@@ -0,0 +1,844 @@
+#include <arena_resource.hpp>
+#include <class.hpp>
+#include <ecs_manager.hpp>
+#include <world_image.hpp>
+#if __has_include(<nlohmann/json.hpp>)
+#include <extra/game_factory.hpp>
+#include <extra/scene_loader.hpp>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <execution>
+#include <filesystem>
+#include <memory_resource>
+#include <new>
+#include <random>
+#include <span>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <sys/resource.h>
+
+// Every allocation of the process is counted, the suite reports those made
+// while measuring.
+std::atomic<std::uint64_t> allocations{};
+std::atomic<std::uint64_t> allocated_bytes{};
+
+auto
+CountAllocation(std::size_t size) -> void
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+auto
+operator new(std::size_t size) -> void*
+{
+  CountAllocation(size);
+  if (auto* ptr{ std::malloc(std::max(size, std::size_t{ 1 })) }) {
+    return ptr;
+  }
+  std::abort();
+}
+
+auto
+operator new(std::size_t size, std::align_val_t align) -> void*
+{
+  CountAllocation(size);
+  // aligned_alloc takes multiples of the alignment only
+  auto alignment{ static_cast<std::size_t>(align) };
+  auto rounded{ std::max((size + alignment - 1) / alignment, std::size_t{ 1 }) * alignment };
+  if (auto* ptr{ std::aligned_alloc(alignment, rounded) }) {
+    return ptr;
+  }
+  std::abort();
+}
+
+// GCC takes free inlined in operator delete for a mismatch with operator new
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+auto
+operator delete(void* ptr) noexcept -> void
+{
+  std::free(ptr);
+}
+
+auto
+operator delete(void* ptr, std::size_t) noexcept -> void
+{
+  std::free(ptr);
+}
+
+auto
+operator delete(void* ptr, std::align_val_t) noexcept -> void
+{
+  std::free(ptr);
+}
+
+auto
+operator delete(void* ptr, std::size_t, std::align_val_t) noexcept -> void
+{
+  std::free(ptr);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+struct PositionComponent_t
+{
+  float x, y;
+};
+
+struct PhysicsComponent_t
+{
+  float vx, vy;
+};
+
+struct Movable_t : ECS::Class_t<PositionComponent_t, PhysicsComponent_t>
+{};
+
+// tags take no storage
+struct EnemyTag_t
+{};
+
+struct DynamicTag_t
+{};
+
+struct NetworkedTag_t
+{};
+
+struct VisibleTag_t
+{};
+
+struct TaggedMovable_t
+  : ECS::Class_t<PositionComponent_t, PhysicsComponent_t, EnemyTag_t, DynamicTag_t, NetworkedTag_t, VisibleTag_t>
+{};
+
+// position sent over the network when it changes
+struct NetPositionComponent_t
+{
+  static constexpr bool track_changes{ true };
+
+  float x, y;
+};
+
+struct Synced_t : ECS::Class_t<NetPositionComponent_t, PhysicsComponent_t>
+{};
+
+struct BrainComponent_t
+{
+  int state;
+};
+
+struct SleepComponent_t
+{
+  int ticks;
+};
+
+// AI agents only known through their Movable_t base
+struct Thinker_t : ECS::Class_t<Movable_t, BrainComponent_t>
+{};
+
+struct Sleeper_t : ECS::Class_t<Movable_t, SleepComponent_t>
+{};
+
+// a chain of signatures, each level adds a component to the one above
+template<std::size_t Level> struct LevelComponent_t
+{
+  std::size_t value;
+};
+
+template<std::size_t Level> struct Level_t : ECS::Class_t<Level_t<Level - 1>, LevelComponent_t<Level>>
+{};
+
+template<> struct Level_t<0> : ECS::Class_t<PositionComponent_t, PhysicsComponent_t>
+{};
+
+template<std::size_t... Levels> auto LevelsOf(std::index_sequence<Levels...>) -> TMPL::TypeList_t<Level_t<Levels>...>;
+
+template<std::size_t Depth> struct HierarchyConfig_t
+{
+  using Signatures_t = decltype(LevelsOf(std::make_index_sequence<Depth + 1>{}));
+};
+
+struct SyncConfig_t
+{
+  using Signatures_t = TMPL::TypeList_t<Synced_t>;
+  using Storage_t    = ECS::ArchetypeStorage_t;
+};
+
+struct AIConfig_t
+{
+  using Signatures_t = TMPL::TypeList_t<Movable_t, Thinker_t, Sleeper_t>;
+};
+
+struct VirtualAIConfig_t
+{
+  using Signatures_t  = TMPL::TypeList_t<Movable_t, Thinker_t, Sleeper_t>;
+  using BaseStorage_t = ECS::VirtualBases_t;
+};
+
+struct HeapConfig_t
+{
+  using Signatures_t = TMPL::TypeList_t<Movable_t>;
+};
+
+struct TracedConfig_t
+{
+  using Signatures_t = TMPL::TypeList_t<Movable_t>;
+  using Tracer_t     = ECS::TraceRecorder_t;
+};
+
+struct NarrowConfig_t
+{
+  using Signatures_t = TMPL::TypeList_t<Movable_t>;
+  using Index_t      = std::uint32_t;
+};
+
+struct TagConfig_t
+{
+  using Signatures_t = TMPL::TypeList_t<TaggedMovable_t>;
+};
+
+struct ArenaConfig_t
+{
+  using Signatures_t = TMPL::TypeList_t<Movable_t>;
+
+  template<class T> using Allocator_t = std::pmr::polymorphic_allocator<T>;
+};
+
+constexpr auto entities{ 100'000 };
+constexpr auto rounds{ 20 };
+
+template<class Sign_t = Movable_t, class ECSManager_t>
+auto
+CreateDestroy(ECSManager_t& ecs_man) -> void
+{
+  std::vector<typename ECSManager_t::template handle_type<Sign_t>> handles{};
+  handles.reserve(entities);
+  for (auto i{ 0 }; i < entities; ++i) {
+    handles.emplace_back(ecs_man.template CreateEntity<Sign_t>(PositionComponent_t{}, PhysicsComponent_t{ 1, 1 }));
+  }
+  for (auto e : handles) {
+    ecs_man.Destroy(e);
+  }
+}
+
+template<class ECSManager_t>
+auto
+CreateDestroyBatch(ECSManager_t& ecs_man) -> void
+{
+  auto handles{ ecs_man.template CreateEntities<Movable_t>(
+    entities, [](std::size_t) { return std::tuple{ PhysicsComponent_t{ 1, 1 } }; }) };
+  for (auto e : handles) {
+    ecs_man.Destroy(e);
+  }
+}
+
+// destroys 30% of the entities, in a scattered order
+template<class ECSManager_t>
+auto
+Cull(ECSManager_t& ecs_man, bool bulk) -> void
+{
+  auto handles{ ecs_man.template CreateEntities<Movable_t>(
+    entities, [](std::size_t i) { return std::tuple{ PositionComponent_t{ static_cast<float>(i % 10), 0 } }; }) };
+  std::shuffle(handles.begin(), handles.end(), std::minstd_rand{});
+  std::erase_if(handles, [&](auto e) { return ecs_man.template GetComponent<PositionComponent_t>(e).x >= 3; });
+  if (bulk) {
+    ecs_man.template Destroy<Movable_t>(handles);
+  } else {
+    for (auto e : handles) {
+      ecs_man.Destroy(e);
+    }
+  }
+}
+
+// measured cost of a scenario, per round of count entities
+struct Result_t
+{
+  std::string   group;
+  std::string   name;
+  std::size_t   count;
+  std::size_t   rounds;
+  double        ns_per_entity;
+  double        allocs_per_round;
+  double        bytes_per_round;
+  std::uint64_t peak_rss_kb;
+};
+
+std::vector<Result_t> results{};
+std::string           group{};
+
+auto
+Group(std::string name) -> void
+{
+  group = std::move(name);
+  std::printf("-- %s\n", group.c_str());
+}
+
+// Peak resident set of the process. Linux resets it when asked, so every
+// measure reports its own peak, elsewhere the peak of the whole run.
+auto
+ResetPeakRSS() -> void
+{
+  if (auto* file{ std::fopen("/proc/self/clear_refs", "w") }) {
+    std::fputs("5", file);
+    std::fclose(file);
+  }
+}
+
+auto
+PeakRSS() -> std::uint64_t
+{
+  std::uint64_t peak_kb{};
+  if (auto* file{ std::fopen("/proc/self/status", "r") }) {
+    char line[256]{};
+    while (peak_kb == 0 && std::fgets(line, sizeof(line), file) != nullptr) {
+      if (std::strncmp(line, "VmHWM:", 6) == 0) {
+        peak_kb = std::strtoull(line + 6, nullptr, 10);
+      }
+    }
+    std::fclose(file);
+  }
+  if (peak_kb == 0) {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    peak_kb = static_cast<std::uint64_t>(usage.ru_maxrss);
+  }
+  return peak_kb;
+}
+
+struct NoSetup_t
+{
+  auto operator()() const -> void {}
+};
+
+// Runs fn times, setup runs before each round and is not measured.
+template<class Fn_t, class Setup_t = NoSetup_t>
+auto
+Measure(const char* name, Fn_t&& fn, std::size_t count = entities, int times = rounds, Setup_t&& setup = {}) -> void
+{
+  ResetPeakRSS();
+  std::chrono::duration<double, std::milli> elapsed{};
+  std::uint64_t                             allocs{};
+  std::uint64_t                             bytes{};
+  for (auto i{ 0 }; i < times; ++i) {
+    setup();
+    auto first_allocs{ allocations.load(std::memory_order_relaxed) };
+    auto first_bytes{ allocated_bytes.load(std::memory_order_relaxed) };
+    auto start{ std::chrono::steady_clock::now() };
+    fn();
+    elapsed += std::chrono::steady_clock::now() - start;
+    allocs += allocations.load(std::memory_order_relaxed) - first_allocs;
+    bytes += allocated_bytes.load(std::memory_order_relaxed) - first_bytes;
+  }
+  const auto per_round{ static_cast<double>(std::max(times, 1)) };
+  Result_t   result{ group,
+                   name,
+                   count,
+                   static_cast<std::size_t>(times),
+                   elapsed.count() * 1e6 / (static_cast<double>(std::max(count, std::size_t{ 1 })) * per_round),
+                   static_cast<double>(allocs) / per_round,
+                   static_cast<double>(bytes) / per_round,
+                   PeakRSS() };
+  std::printf("%-14s %10.2f ms %10.2f ns/entity %12.1f allocs %10.1f MB peak\n",
+              name,
+              elapsed.count(),
+              result.ns_per_entity,
+              result.allocs_per_round,
+              static_cast<double>(result.peak_rss_kb) / 1024);
+  results.push_back(std::move(result));
+}
+
+// One result per line, so the files of two runs can be diffed.
+auto
+WriteResults(const char* path) -> bool
+{
+  auto* file{ std::fopen(path, "w") };
+  if (file == nullptr) {
+    return false;
+  }
+  std::fputs("[\n", file);
+  for (std::size_t i{}; i < results.size(); ++i) {
+    const auto& result{ results[i] };
+    std::fprintf(file,
+                 "  {\"group\": \"%s\", \"name\": \"%s\", \"count\": %zu, \"rounds\": %zu, \"ns_per_entity\": %.3f, "
+                 "\"allocs_per_round\": %.1f, \"bytes_per_round\": %.0f, \"peak_rss_kb\": %llu}%s\n",
+                 result.group.c_str(),
+                 result.name.c_str(),
+                 result.count,
+                 result.rounds,
+                 result.ns_per_entity,
+                 result.allocs_per_round,
+                 result.bytes_per_round,
+                 static_cast<unsigned long long>(result.peak_rss_kb),
+                 i + 1 < results.size() ? "," : "");
+  }
+  std::fputs("]\n", file);
+  return std::fclose(file) == 0;
+}
+
+constexpr auto integrate{ [](PositionComponent_t& pos, PhysicsComponent_t& phy) {
+  phy.vx = std::sqrt(phy.vx * phy.vx + pos.y * 1e-3f);
+  pos.x += phy.vx * 0.016f;
+  pos.y += phy.vy * 0.016f;
+} };
+
+auto
+Traverse(std::size_t count) -> void
+{
+  ECS::ECSManager_t<HeapConfig_t> ecs_man{};
+  ecs_man.CreateEntities<Movable_t>(count, [](std::size_t i) {
+    return std::tuple{ PhysicsComponent_t{ static_cast<float>(i % 7), 1 } };
+  });
+  auto times{ static_cast<int>(10'000'000 / count) };
+  Group(std::to_string(count) + " entities");
+  Measure("seq", [&] { ecs_man.ForEach<Movable_t>(integrate); }, count, times);
+  Measure("jobs", [&] { ecs_man.ParallelForEach<Movable_t>(integrate); }, count, times);
+  Measure("chunks", [&] {
+    ecs_man.ForEachChunk<Movable_t>([](std::span<PositionComponent_t> pos, std::span<PhysicsComponent_t> phy) {
+      for (std::size_t i{}; i < pos.size(); ++i) {
+        integrate(pos[i], phy[i]);
+      }
+    });
+  }, count, times);
+#if defined(__cpp_exceptions)
+  Measure("par_unseq", [&] { ecs_man.ParallelForEach<Movable_t>(std::execution::par_unseq, integrate); }, count, times);
+#else
+  // libstdc++ parallel algorithms need exceptions (and TBB to run in parallel)
+  std::printf("%-14s skipped, build with -fexceptions\n", "par_unseq");
+#endif
+}
+
+// moves a run of 5% of the entities every round, then gathers the positions to
+// send. Scattered changes touch most chunks and only save the callbacks.
+auto
+Sync() -> void
+{
+  ECS::ECSManager_t<SyncConfig_t> ecs_man{};
+  const auto&                     reader{ ecs_man };
+  auto handles{ ecs_man.CreateEntities<Synced_t>(entities, [](std::size_t) { return std::tuple{}; }) };
+  std::minstd_rand rng{};
+  std::vector<NetPositionComponent_t> packet{};
+  auto move{ [&] {
+    auto first{ rng() % handles.size() };
+    for (auto i{ 0 }; i < entities / 20; ++i) {
+      ecs_man.GetComponent<NetPositionComponent_t>(handles[(first + i) % handles.size()]).x += 1;
+    }
+  } };
+  Measure("sync all", [&] {
+    move();
+    packet.clear();
+    reader.ForEach<Synced_t>(
+      [&](const NetPositionComponent_t& pos, const PhysicsComponent_t&) { packet.push_back(pos); });
+  });
+  auto last_sync{ ecs_man.Tick() };
+  Measure("sync changed", [&] {
+    move();
+    packet.clear();
+    reader.ForEachChanged<Synced_t, NetPositionComponent_t>(
+      last_sync, [&](const NetPositionComponent_t& pos, const PhysicsComponent_t&) { packet.push_back(pos); });
+    last_sync = ecs_man.Tick();
+  });
+}
+
+// Match and Destroy through base handles, resolving the concrete entity of
+// each, and ForEach over the base against ForEachWith over the concrete
+// signatures. Destroy includes creating the entities again.
+template<class Config_t>
+auto
+Dispatch(const char* bases) -> void
+{
+  using ECSManager_t = ECS::ECSManager_t<Config_t>;
+  Group(std::string{ bases } + " bases");
+  ECSManager_t                                                       ecs_man{};
+  std::vector<typename ECSManager_t::template handle_type<Movable_t>> handles{};
+  auto spawn{ [&] {
+    handles.clear();
+    for (auto i{ 0 }; i < entities; ++i) {
+      if (i % 2 == 0) {
+        handles.push_back(
+          ecs_man.template GetBaseID<Movable_t>(ecs_man.template CreateEntity<Thinker_t>(BrainComponent_t{ i })));
+      } else {
+        handles.push_back(
+          ecs_man.template GetBaseID<Movable_t>(ecs_man.template CreateEntity<Sleeper_t>(SleepComponent_t{ i })));
+      }
+    }
+    std::shuffle(handles.begin(), handles.end(), std::minstd_rand{});
+  } };
+  spawn();
+  long total{};
+  Measure("match", [&] {
+    for (auto e : handles) {
+      ecs_man.template Match<Thinker_t>(
+        e, [&](PositionComponent_t&, PhysicsComponent_t&, BrainComponent_t& brain) { total += brain.state; });
+      ecs_man.template Match<Sleeper_t>(
+        e, [&](PositionComponent_t&, PhysicsComponent_t&, SleepComponent_t& sleep) { total -= sleep.ticks++; });
+    }
+  });
+  Measure("foreach", [&] {
+    ecs_man.template ForEach<Movable_t>([&](PositionComponent_t& pos, PhysicsComponent_t& phy) {
+      pos.x += phy.vx;
+      total += static_cast<long>(pos.x);
+    });
+  });
+  Measure("with", [&] {
+    ecs_man.template ForEachWith<PositionComponent_t, PhysicsComponent_t>(
+      [&](PositionComponent_t& pos, PhysicsComponent_t& phy) {
+        pos.x += phy.vx;
+        total += static_cast<long>(pos.x);
+      });
+  });
+  Measure("without", [&] {
+    ecs_man.template ForEachWith<PositionComponent_t, ECS::Without_t<SleepComponent_t>>(
+      [&](PositionComponent_t& pos) { total += static_cast<long>(pos.x); });
+  });
+  Measure("destroy", [&] {
+    for (auto e : handles) {
+      ecs_man.Destroy(e);
+    }
+    spawn();
+  });
+  std::printf("%-14s %10ld\n", "checksum", total);
+}
+
+// The core operations on count leaves of a hierarchy Depth levels deep: the
+// base handles and rows of every level are kept up to date.
+template<std::size_t Depth>
+auto
+Hierarchy(std::size_t count) -> void
+{
+  using ECSManager_t = ECS::ECSManager_t<HierarchyConfig_t<Depth>>;
+  using Root_t       = Level_t<0>;
+  using Leaf_t       = Level_t<Depth>;
+  Group("depth " + std::to_string(Depth) + ", " + std::to_string(count) + " entities");
+  auto         times{ static_cast<int>(std::max(1'000'000 / count, std::size_t{ 1 })) };
+  ECSManager_t ecs_man{};
+  std::vector<typename ECSManager_t::template handle_type<Leaf_t>> leaves{};
+  std::vector<typename ECSManager_t::template handle_type<Root_t>> roots{};
+  auto create{ [&] {
+    for (std::size_t i{}; i < count; ++i) {
+      leaves.push_back(ecs_man.template CreateEntity<Leaf_t>(PhysicsComponent_t{ 1, static_cast<float>(i % 7) }));
+    }
+  } };
+  auto destroy{ [&] {
+    for (auto e : leaves) {
+      ecs_man.Destroy(e);
+    }
+    leaves.clear();
+  } };
+  leaves.reserve(count);
+  roots.reserve(count);
+  Measure("create", create, count, times, destroy);
+  Measure("destroy", destroy, count, times, create);
+  create();
+  Measure("foreach", [&] { ecs_man.template ForEach<Root_t>(integrate); }, count, times);
+  Measure("parallel", [&] { ecs_man.template ParallelForEach<Root_t>(integrate); }, count, times);
+  // to the root and back, every level below is dropped and made again
+  Measure("transform", [&] {
+    for (auto& e : leaves) {
+      e = ecs_man.template TransformTo<Leaf_t>(ecs_man.template TransformTo<Root_t>(e));
+    }
+  }, count, times);
+  for (auto e : leaves) {
+    roots.push_back(ecs_man.template GetBaseID<Root_t>(e));
+  }
+  std::shuffle(roots.begin(), roots.end(), std::minstd_rand{});
+  double total{};
+  Measure("match", [&] {
+    for (auto e : roots) {
+      ecs_man.template Match<Leaf_t>(e, [&](PositionComponent_t& pos, auto&&...) { total += pos.x; });
+    }
+  }, count, times);
+  std::printf("%-14s %10.0f\n", "checksum", total);
+  typename ECSManager_t::stats_type stats{};
+  Measure("stats", [&] { stats = ecs_man.Stats(); }, count, times);
+  std::printf("%-14s %10zu bytes used %zu held\n", "memory", stats.UsedBytes(), stats.AllocatedBytes());
+}
+
+// Saving and loading a world against creating its entities one by one, as a
+// level loader without snapshots does.
+auto
+Snapshot() -> void
+{
+  using ECSManager_t = ECS::ECSManager_t<AIConfig_t>;
+  auto populate{ [](ECSManager_t& ecs_man) {
+    for (auto i{ 0 }; i < entities; ++i) {
+      if (i % 2 == 0) {
+        ecs_man.CreateEntity<Thinker_t>(PositionComponent_t{ static_cast<float>(i), 0 }, BrainComponent_t{ i });
+      } else {
+        ecs_man.CreateEntity<Sleeper_t>(PositionComponent_t{ static_cast<float>(i), 0 }, SleepComponent_t{ i });
+      }
+    }
+  } };
+  Measure("rebuild", [&] {
+    ECSManager_t ecs_man{};
+    populate(ecs_man);
+  });
+  ECSManager_t world{};
+  populate(world);
+  std::vector<std::byte> bytes{};
+  Measure("save", [&] {
+    ECS::SnapshotWriter_t out{};
+    out.Reserve(bytes.size());
+    world.Save(out);
+    bytes = out.Release();
+  });
+  bool loaded{ true };
+  Measure("load", [&] {
+    ECSManager_t          ecs_man{};
+    ECS::SnapshotReader_t in{ bytes };
+    loaded = loaded && ecs_man.Load(in);
+  });
+  // the image goes to the temporary directory and the page cache holds it
+  // after the first round, as for a level loaded again
+  std::error_code ec{};
+  const auto      path{ (std::filesystem::temp_directory_path(ec) / "oop_ecs_bench_world.img").string() };
+  loaded = loaded && ECS::WorldImage_t::Write(path.c_str(), bytes);
+  Measure("map", [&] {
+    ECS::WorldImage_t image{};
+    loaded = loaded && image.Open(path.c_str());
+    ECSManager_t ecs_man{};
+    auto         in{ image.GetReader() };
+    loaded = loaded && ecs_man.Map(in);
+  });
+  std::remove(path.c_str());
+  std::printf("%-14s %10zu bytes %s\n", "snapshot", bytes.size(), loaded ? "" : "load failed");
+}
+
+#if __has_include(<nlohmann/json.hpp>)
+auto
+from_json(const nlohmann::json& j, PositionComponent_t& pos) -> void
+{
+  pos = { j.value("x", 0.f), j.value("y", 0.f) };
+}
+
+auto
+from_json(const nlohmann::json& j, PhysicsComponent_t& phy) -> void
+{
+  phy = { j.value("vx", 0.f), j.value("vy", 0.f) };
+}
+
+auto
+from_json(const nlohmann::json& j, BrainComponent_t& brain) -> void
+{
+  brain = { j.value("state", 0) };
+}
+
+auto
+from_json(const nlohmann::json& j, SleepComponent_t& sleep) -> void
+{
+  sleep = { j.value("ticks", 0) };
+}
+
+// a scene of a million movables, thinkers and sleepers read through a whole
+// document or streamed
+auto
+Scene() -> void
+{
+  using ECSManager_t = ECS::ECSManager_t<AIConfig_t>;
+  constexpr auto count{ 1'000'000 };
+  constexpr auto times{ 3 };
+
+  std::string scene{ "{" };
+  for (auto sig{ 0 }; sig < 3; ++sig) {
+    scene += (sig == 0 ? "\"" : "],\"") + std::to_string(sig) + "\":[";
+    for (auto i{ sig }; i < count; i += 3) {
+      scene += (i == sig ? "{\"x\":" : ",{\"x\":") + std::to_string(i) + ",\"y\":1.5,\"vx\":0.25,\"vy\":-1";
+      scene += sig == 0 ? "}" : (sig == 1 ? ",\"state\":" : ",\"ticks\":") + std::to_string(i % 7) + "}";
+    }
+  }
+  scene += "]}";
+
+  std::size_t loaded{};
+  Measure(
+    "scene dom",
+    [&] {
+      ECSManager_t ecs_man{};
+      // braces would wrap the document in an array
+      const auto doc = nlohmann::json::parse(scene);
+      for (const auto& ent : doc["0"]) {
+        ecs_man.CreateEntity<Movable_t>(ent.get<PositionComponent_t>(), ent.get<PhysicsComponent_t>());
+      }
+      for (const auto& ent : doc["1"]) {
+        ecs_man.CreateEntity<Thinker_t>(
+          ent.get<PositionComponent_t>(), ent.get<PhysicsComponent_t>(), ent.get<BrainComponent_t>());
+      }
+      for (const auto& ent : doc["2"]) {
+        ecs_man.CreateEntity<Sleeper_t>(
+          ent.get<PositionComponent_t>(), ent.get<PhysicsComponent_t>(), ent.get<SleepComponent_t>());
+      }
+      loaded = ecs_man.Size<Movable_t>();
+    },
+    count,
+    times);
+  Measure(
+    "scene stream",
+    [&] {
+      ECSManager_t                ecs_man{};
+      GameFactory_t<ECSManager_t> factory{ ecs_man };
+      factory.StreamScene(scene);
+      loaded = std::min(loaded, ecs_man.Size<Movable_t>());
+    },
+    count,
+    times);
+  Measure(
+    "scene jobs",
+    [&] {
+      ECSManager_t                      ecs_man{};
+      ECS::SceneLoader_t<ECSManager_t> loader{ ecs_man, 4096, &ECS::JobSystem_t::Default() };
+      loader.Load(scene);
+      loaded = std::min(loaded, loader.Loaded());
+    },
+    count,
+    times);
+  std::printf("%-14s %10zu bytes %zu entities\n", "scene", scene.size(), loaded);
+}
+
+// GameFactory_t hook, the components are all the bench entities need
+template<class Handle_t>
+auto
+ConfigureEntityFromJson(Handle_t, const nlohmann::json&) -> void
+{}
+
+// thinkers spawned from a config, decoded on every spawn or once in a prefab
+auto
+Prefab() -> void
+{
+  using ECSManager_t = ECS::ECSManager_t<AIConfig_t>;
+  const auto config  = nlohmann::json::parse(R"({ "1": { "x": 1, "y": 2, "vx": 0.5, "vy": 0.5, "state": 3 } })");
+
+  Measure("prefab decode", [&] {
+    ECSManager_t ecs_man{};
+    for (auto i{ 0 }; i < entities; ++i) {
+      const auto& ent{ config[std::to_string(1)] };
+      ecs_man.CreateEntity<Thinker_t>(
+        ent.get<PositionComponent_t>(), ent.get<PhysicsComponent_t>(), ent.get<BrainComponent_t>());
+    }
+  });
+
+  Measure("prefab cached", [&] {
+    ECSManager_t                ecs_man{};
+    GameFactory_t<ECSManager_t> factory{ ecs_man, config };
+    for (auto i{ 0 }; i < entities; ++i) {
+      factory.EntityFromConfig<Thinker_t>();
+    }
+  });
+  Measure("prefab batch", [&] {
+    ECSManager_t                ecs_man{};
+    GameFactory_t<ECSManager_t> factory{ ecs_man, config };
+    factory.EntitiesFromConfig<Thinker_t>(entities);
+  });
+}
+#else
+auto
+Scene() -> void
+{
+  std::printf("%-14s skipped, nlohmann/json.hpp not found\n", "scene");
+}
+
+auto
+Prefab() -> void
+{
+  std::printf("%-14s skipped, nlohmann/json.hpp not found\n", "prefab");
+}
+#endif
+
+// Results are written to the file given as argument, or named by
+// BENCH_OUTPUT, bench_results.json otherwise. The last events of the traced
+// run are written to BENCH_TRACE when it is set.
+auto
+main(int argc, char** argv) -> int
+{
+  const char* output{ argc > 1 ? argv[1] : std::getenv("BENCH_OUTPUT") };
+
+  Group("create and destroy");
+  Measure("heap", [] {
+    ECS::ECSManager_t<HeapConfig_t> ecs_man{};
+    CreateDestroy(ecs_man);
+  });
+
+  Measure("traced", [] {
+    ECS::ECSManager_t<TracedConfig_t> ecs_man{};
+    CreateDestroy(ecs_man);
+  });
+
+  Measure("narrow", [] {
+    ECS::ECSManager_t<NarrowConfig_t> ecs_man{};
+    CreateDestroy(ecs_man);
+  });
+
+  Measure("tagged", [] {
+    ECS::ECSManager_t<TagConfig_t> ecs_man{};
+    CreateDestroy<TaggedMovable_t>(ecs_man);
+  });
+
+  Measure("batch", [] {
+    ECS::ECSManager_t<HeapConfig_t> ecs_man{};
+    CreateDestroyBatch(ecs_man);
+  });
+
+  Measure("cull", [] {
+    ECS::ECSManager_t<HeapConfig_t> ecs_man{};
+    Cull(ecs_man, false);
+  });
+
+  Measure("bulk", [] {
+    ECS::ECSManager_t<HeapConfig_t> ecs_man{};
+    Cull(ecs_man, true);
+  });
+
+  ECS::ArenaResource_t arena{ 16 * 1024 * 1024 };
+  Measure("arena", [&] {
+    {
+      ECS::ECSManager_t<ArenaConfig_t> ecs_man{ &arena };
+      CreateDestroy(ecs_man);
+    }
+    arena.Release();
+  });
+
+  Group("changes");
+  Sync();
+
+  Dispatch<AIConfig_t>("materialized");
+  Dispatch<VirtualAIConfig_t>("virtual");
+
+  for (std::size_t count : { 10'000, 100'000, 1'000'000 }) {
+    Hierarchy<1>(count);
+    Hierarchy<2>(count);
+    Hierarchy<4>(count);
+  }
+
+  Group("snapshot");
+  Snapshot();
+
+  Group("game factory");
+  Scene();
+  Prefab();
+
+  auto& jobs{ ECS::JobSystem_t::Default() };
+  std::printf("-- %zu job threads, grain %zu\n", jobs.WorkerCount(), jobs.Grain());
+  for (std::size_t count : { 10'000, 100'000, 1'000'000 }) {
+    Traverse(count);
+  }
+
+  if (const char* trace{ std::getenv("BENCH_TRACE") }) {
+    ECS::TraceRecorder_t::Default().WriteChromeTrace(trace);
+  }
+  if (!WriteResults(output != nullptr ? output : "bench_results.json")) {
+    std::printf("could not write the results\n");
+    return 1;
+  }
+  return 0;
+}
@@ -1,4 +1,5 @@
 #include <class.hpp>
+#include <command_buffer.hpp>
 #include <ecs_manager.hpp>
 #include <iostream>
 #include <traits.hpp>
@@ -88,7 +89,9 @@ main() -> int
   ecs_man.ForEach<BasicCharacter_t>(basic_character_printer);
 
   std::cout << "Converting basic character to movable..." << std::endl;
-  ecs_man.ForEach<BasicCharacter_t>([&](auto&, auto&, auto&, auto&& ent) { ecs_man.TransformTo<Movable_t>(ent); });
+  ECS::CommandBuffer_t<decltype(ecs_man)> commands{};
+  ecs_man.ForEach<BasicCharacter_t>([&](auto&, auto&, auto&, auto&& ent) { commands.TransformTo<Movable_t>(ent); });
+  commands.Playback(ecs_man);
 
   std::cout << "Iterating over renderables..." << std::endl;
   ecs_man.ForEach<Renderable_t>(rendereable_printer);
@@ -102,9 +105,10 @@ main() -> int
   std::cout << "Converting back basic character..." << std::endl;
   ecs_man.ForEach<Movable_t>([&](auto& phy, auto&, auto e) {
     if (phy.vx == 5 && phy.vy == 4) {
-      ecs_man.TransformTo<BasicCharacter_t>(e, RenderComponent_t{ 'd' });
+      commands.TransformTo<BasicCharacter_t>(e, RenderComponent_t{ 'd' });
     }
   });
+  commands.Playback(ecs_man);
 
   std::cout << "Iterating over renderables..." << std::endl;
   ecs_man.ForEach<Renderable_t>(rendereable_printer);
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+
+namespace ECS {
+
+// Bump allocator meant to back a whole world, e.g. through
+// `template<class T> using Allocator_t = std::pmr::polymorphic_allocator<T>;`
+// in the manager config. Deallocating only gives back the last allocation,
+// everything else is returned at once by Release() or by the destructor, so
+// the worlds using the arena must be destroyed first. When the current block
+// is exhausted a bigger one is requested from the upstream resource.
+struct ArenaResource_t final : std::pmr::memory_resource
+{
+  explicit ArenaResource_t(std::size_t                capacity,
+                           std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+    : mUpstream{ upstream }
+    , mBlockSize{ std::max(capacity, sizeof(Block_t)) }
+  {
+    Reset();
+    AddBlock(0);
+  }
+
+  // Uses a buffer owned by the caller, e.g. pre-reserved huge pages, before
+  // falling back to the upstream resource.
+  explicit ArenaResource_t(std::span<std::byte>       buffer,
+                           std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+    : mBuffer{ buffer }
+    , mUpstream{ upstream }
+    , mBlockSize{ std::max(buffer.size(), sizeof(Block_t)) }
+  {
+    Reset();
+  }
+
+  ArenaResource_t(const ArenaResource_t&)                    = delete;
+  auto operator=(const ArenaResource_t&) -> ArenaResource_t& = delete;
+
+  ~ArenaResource_t() override { Release(); }
+
+  auto Release() -> void
+  {
+    while (mBlocks != nullptr) {
+      auto* next{ mBlocks->mNext };
+      mUpstream->deallocate(mBlocks, mBlocks->mSize, alignof(std::max_align_t));
+      mBlocks = next;
+    }
+    Reset();
+  }
+
+  // Makes all the memory available again but keeps the newest block, which is
+  // the biggest one, so an arena reused every frame stops asking upstream.
+  auto Rewind() -> void
+  {
+    if (mBlocks == nullptr) {
+      Reset();
+      return;
+    }
+    while (mBlocks->mNext != nullptr) {
+      auto* next{ mBlocks->mNext->mNext };
+      mUpstream->deallocate(mBlocks->mNext, mBlocks->mNext->mSize, alignof(std::max_align_t));
+      mBlocks->mNext = next;
+    }
+    mCurrent = reinterpret_cast<std::byte*>(mBlocks) + sizeof(Block_t);
+    mEnd     = reinterpret_cast<std::byte*>(mBlocks) + mBlocks->mSize;
+    mLast    = nullptr;
+  }
+
+  auto Upstream() const -> std::pmr::memory_resource* { return mUpstream; }
+
+private:
+  struct Block_t
+  {
+    Block_t*    mNext{};
+    std::size_t mSize{};
+  };
+
+  auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override
+  {
+    auto* ptr{ Align(mCurrent, alignment) };
+    if (ptr == nullptr || mEnd - ptr < static_cast<std::ptrdiff_t>(bytes)) {
+      AddBlock(bytes + alignment);
+      ptr = Align(mCurrent, alignment);
+    }
+    mLast    = ptr;
+    mCurrent = ptr + bytes;
+    return ptr;
+  }
+
+  auto do_deallocate(void* ptr, std::size_t bytes, std::size_t) -> void override
+  {
+    if (ptr == mLast && mLast + bytes == mCurrent) {
+      mCurrent = mLast;
+    }
+  }
+
+  auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override { return this == &other; }
+
+  static auto Align(std::byte* ptr, std::size_t alignment) -> std::byte*
+  {
+    if (ptr == nullptr) {
+      return nullptr;
+    }
+    auto addr{ reinterpret_cast<std::uintptr_t>(ptr) };
+    return ptr + ((alignment - addr % alignment) % alignment);
+  }
+
+  auto AddBlock(std::size_t min_bytes) -> void
+  {
+    auto size{ std::max(mNextBlockSize, min_bytes + sizeof(Block_t)) };
+    auto* block{ static_cast<Block_t*>(mUpstream->allocate(size, alignof(std::max_align_t))) };
+    block->mNext   = mBlocks;
+    block->mSize   = size;
+    mBlocks        = block;
+    mCurrent       = reinterpret_cast<std::byte*>(block) + sizeof(Block_t);
+    mEnd           = reinterpret_cast<std::byte*>(block) + size;
+    mLast          = nullptr;
+    mNextBlockSize = size * 2;
+  }
+
+  auto Reset() -> void
+  {
+    mCurrent       = mBuffer.data();
+    mEnd           = mBuffer.data() + mBuffer.size();
+    mLast          = nullptr;
+    mNextBlockSize = mBlockSize;
+  }
+
+  std::span<std::byte>       mBuffer{};
+  std::pmr::memory_resource* mUpstream{};
+  Block_t*                   mBlocks{};
+  std::byte*                 mCurrent{};
+  std::byte*                 mEnd{};
+  std::byte*                 mLast{};
+  std::size_t                mBlockSize{};
+  std::size_t                mNextBlockSize{};
+};
+
+} // namespace ECS
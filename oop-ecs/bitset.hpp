@@ -0,0 +1,69 @@
+#pragma once
+
+#include "snapshot.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ECS {
+
+// Bitset growing on demand, the bits past the end read as unset.
+template<class Alloc_t = std::allocator<std::uint64_t>> struct Bitset_t
+{
+  using word_type      = std::uint64_t;
+  using size_type      = std::size_t;
+  using allocator_type = typename std::allocator_traits<Alloc_t>::template rebind_alloc<word_type>;
+
+  static constexpr size_type word_bits{ 64 };
+
+  constexpr explicit Bitset_t(const Alloc_t& alloc = Alloc_t{})
+    : mWords{ allocator_type{ alloc } }
+  {
+  }
+
+  constexpr auto test(size_type pos) const -> bool
+  {
+    auto word{ pos / word_bits };
+    return word < mWords.size() && ((mWords[word] >> (pos % word_bits)) & 1) != 0;
+  }
+
+  constexpr auto set(size_type pos) -> void
+  {
+    auto word{ pos / word_bits };
+    if (word >= mWords.size()) {
+      mWords.resize(word + 1);
+    }
+    mWords[word] |= word_type{ 1 } << (pos % word_bits);
+  }
+
+  constexpr auto reset(size_type pos) -> void
+  {
+    auto word{ pos / word_bits };
+    if (word < mWords.size()) {
+      mWords[word] &= ~(word_type{ 1 } << (pos % word_bits));
+    }
+  }
+
+  constexpr auto count() const -> size_type
+  {
+    size_type count{};
+    for (auto word : mWords) {
+      count += static_cast<size_type>(std::popcount(word));
+    }
+    return count;
+  }
+
+  constexpr auto clear() -> void { mWords.clear(); }
+
+  constexpr auto save(SnapshotWriter_t& out) const -> void { out.WriteArray(mWords); }
+
+  constexpr auto load(SnapshotReader_t& in) -> bool { return in.ReadArray(mWords); }
+
+private:
+  std::vector<word_type, allocator_type> mWords;
+};
+
+} // namespace ECS
@@ -9,4 +9,8 @@ template<class... Ts> struct Class_t
   using types = TMPL::TypeList_t<Ts...>;
 };
 
+// Filter of ECSManager_t::ForEachWith, leaves out the signatures with any of Ts
+template<class... Ts> struct Without_t
+{};
+
 } // namespace ECS
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "arena_resource.hpp"
+#include "helpers.hpp"
+#include "type_aliases.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ECS {
+
+// Records structural changes to be applied later with Playback, so they can
+// be requested while the entities are being iterated. The commands and their
+// component payloads are stored in a linear arena and replayed in recording
+// order. A buffer is not thread safe, use one per worker thread and play them
+// back one after another at a sync point.
+// Handles are resolved at playback, so every entity should be changed by at
+// most one command per playback.
+template<class ECSManager_t> struct CommandBuffer_t
+{
+  template<class T> using Handle_t = ECS::Handle_t<T, typename ECSManager_t::index_type>;
+
+  explicit CommandBuffer_t(std::size_t block_bytes = 16 * 1024)
+    : mArena{ block_bytes }
+  {
+  }
+
+  CommandBuffer_t(const CommandBuffer_t&)                    = delete;
+  auto operator=(const CommandBuffer_t&) -> CommandBuffer_t& = delete;
+
+  ~CommandBuffer_t() { Clear(); }
+
+  template<class EntSig_t, class... Args_t> auto CreateEntity(Args_t&&... args) -> void
+  {
+    Push([... args = std::forward<Args_t>(args)](ECSManager_t& ecs_man) mutable {
+      ecs_man.template CreateEntity<EntSig_t>(std::move(args)...);
+    });
+  }
+
+  template<class EntSig_t> auto Destroy(Handle_t<EntSig_t> e) -> void
+  {
+    Push([e](ECSManager_t& ecs_man) { ecs_man.Destroy(e); });
+  }
+
+  template<class DestSig_t, class EntSig_t, class... Args_t>
+  auto TransformTo(Handle_t<EntSig_t> e, Args_t&&... args) -> void
+  {
+    Push([e, ... args = std::forward<Args_t>(args)](ECSManager_t& ecs_man) mutable {
+      ecs_man.template TransformTo<DestSig_t>(e, std::move(args)...);
+    });
+  }
+
+  // applies the commands in recording order and empties the buffer
+  auto Playback(ECSManager_t& ecs_man) -> void { Consume(&ecs_man); }
+
+  // drops the commands without applying them
+  auto Clear() -> void { Consume(nullptr); }
+
+  [[nodiscard]] auto Empty() const -> bool { return mHead == nullptr; }
+
+  auto Size() const -> std::size_t { return mSize; }
+
+private:
+  struct Command_t
+  {
+    // applies the command when ecs_man is not null, then destroys it
+    using Run_t = void (*)(Command_t&, ECSManager_t*);
+
+    Run_t      mRun{};
+    Command_t* mNext{};
+  };
+
+  template<class Fn_t> struct Record_t : Command_t
+  {
+    Fn_t mFn;
+  };
+
+  template<class Rec_t> static auto Run(Command_t& cmd, ECSManager_t* ecs_man) -> void
+  {
+    auto& rec{ static_cast<Rec_t&>(cmd) };
+    if (ecs_man != nullptr) {
+      rec.mFn(*ecs_man);
+    }
+    std::destroy_at(std::addressof(rec));
+  }
+
+  template<class Fn_t> auto Push(Fn_t&& fn) -> void
+  {
+    using Rec_t = Record_t<std::remove_cvref_t<Fn_t>>;
+    auto* rec{ ::new (mArena.allocate(sizeof(Rec_t), alignof(Rec_t)))
+                 Rec_t{ { &Run<Rec_t>, nullptr }, std::forward<Fn_t>(fn) } };
+    if (mTail == nullptr) {
+      mHead = rec;
+    } else {
+      mTail->mNext = rec;
+    }
+    mTail = rec;
+    ++mSize;
+  }
+
+  auto Consume(ECSManager_t* ecs_man) -> void
+  {
+    // the commands are detached first, so playing back may record new ones
+    while (mHead != nullptr) {
+      auto* cmd{ std::exchange(mHead, nullptr) };
+      mTail = nullptr;
+      mSize = 0;
+      while (cmd != nullptr) {
+        auto* next{ cmd->mNext };
+        cmd->mRun(*cmd, ecs_man);
+        cmd = next;
+      }
+    }
+    mArena.Rewind();
+  }
+
+  ArenaResource_t mArena;
+  Command_t*      mHead{};
+  Command_t*      mTail{};
+  std::size_t     mSize{};
+};
+
+} // namespace ECS
@@ -1,8 +1,12 @@
 #pragma once
 
 #include "helpers.hpp"
+#include "snapshot.hpp"
+#include "stats.hpp"
 #include "type_aliases.hpp"
 
+#include <cstddef>
+
 namespace ECS {
 
 template<class Config_t>
@@ -11,32 +15,90 @@ struct ComponentManager_t final
   , Uncopyable_t
 {
 public:
-  using Self_t = ComponentManager_t;
-  using Base_t = typename Config_t::base;
+  using Self_t     = ComponentManager_t;
+  using Base_t     = typename Config_t::base;
+  using index_type = typename Config_t::index_type;
+
+  template<class T> using Handle_t = ECS::Handle_t<T, index_type>;
+  template<class T> using ID_t     = ECS::ID_t<T, index_type>;
 
   constexpr explicit ComponentManager_t()
     : Base_t{}
   {
   }
 
-  template<class Cmp_t> constexpr auto Create(Cmp_t&& cmp) -> auto
+  constexpr explicit ComponentManager_t(const auto& alloc)
+    : Base_t{ alloc }
+  {
+  }
+
+  template<class T, class Cmp_t> using column_type = typename Config_t::template column_type<T, Cmp_t>;
+
+  template<class EntSig_t, class Cmp_t> constexpr auto Create(Cmp_t&& cmp) -> auto
+  {
+    auto& column{ GetColumn<EntSig_t, std::remove_cvref_t<Cmp_t>>() };
+    column.emplace_back(std::forward<Cmp_t>(cmp));
+    return ECS::Handle_t{ column.back_key() };
+  }
+
+  template<class EntSig_t, class Cmp_t> constexpr auto Destroy(Handle_t<Cmp_t> cmp) -> void
+  {
+    Base_t::template erase<column_type<EntSig_t, Cmp_t>>(ID_t<Cmp_t>{ cmp.GetIndex() });
+  }
+
+  template<class EntSig_t, class Cmp_t> constexpr auto Reserve(std::size_t count) -> void
+  {
+    ReserveMore(GetColumn<EntSig_t, Cmp_t>(), count);
+  }
+
+  template<class Col_t> constexpr auto EraseMarked(const auto& marks, Compaction_t compaction) -> void
+  {
+    Base_t::template GetRequiredContainer<Col_t>().erase_marked(marks, compaction);
+  }
+
+  template<class Col_t> constexpr auto SetVersion(Version_t version) -> void
+  {
+    Base_t::template GetRequiredContainer<Col_t>().set_version(version);
+  }
+
+  template<class Col_t> constexpr auto Save(SnapshotWriter_t& out) const -> void
+  {
+    Base_t::template GetRequiredContainer<Col_t>().save(out);
+  }
+
+  template<class Col_t> constexpr auto Load(SnapshotReader_t& in) -> bool
+  {
+    return Base_t::template GetRequiredContainer<Col_t>().load(in);
+  }
+
+  template<class Col_t> constexpr auto Borrow(ImageReader_t& in) -> bool
+  {
+    return Base_t::template GetRequiredContainer<Col_t>().borrow(in);
+  }
+
+  template<class Col_t> constexpr auto GetStats() const -> ContainerStats_t
+  {
+    return MakeContainerStats(TypeName<Col_t>(), Base_t::template GetRequiredContainer<Col_t>());
+  }
+
+  template<class EntSig_t, class Cmp_t> constexpr auto GetComponent(Handle_t<Cmp_t> cmp) const -> const auto&
   {
-    return Handle_t{ Base_t::template emplace_back<std::remove_cvref_t<Cmp_t>>(std::forward<Cmp_t>(cmp)).key() };
+    return Base_t::template operator[]<column_type<EntSig_t, Cmp_t>>(ID_t<Cmp_t>{ cmp.GetIndex() });
   }
 
-  template<class Cmp_t> constexpr auto Destroy(Handle_t<Cmp_t> cmp) -> void
+  template<class EntSig_t, class Cmp_t> constexpr auto GetComponent(Handle_t<Cmp_t> cmp) -> auto&
   {
-    Base_t::template erase<Cmp_t>(ID_t<Cmp_t>{ cmp.GetIndex() });
+    return Base_t::template operator[]<column_type<EntSig_t, Cmp_t>>(ID_t<Cmp_t>{ cmp.GetIndex() });
   }
 
-  template<class Cmp_t> constexpr auto GetComponent(Handle_t<Cmp_t> cmp) const -> const auto&
+  template<class EntSig_t, class Cmp_t> constexpr auto GetColumn() const -> const auto&
   {
-    return Base_t::template operator[]<Cmp_t>(ID_t<Cmp_t>{ cmp.GetIndex() });
+    return Base_t::template GetRequiredContainer<column_type<EntSig_t, Cmp_t>>();
   }
 
-  template<class Cmp_t> constexpr auto GetComponent(Handle_t<Cmp_t> cmp) -> auto&
+  template<class EntSig_t, class Cmp_t> constexpr auto GetColumn() -> auto&
   {
-    return Base_t::template operator[]<Cmp_t>(ID_t<Cmp_t>{ cmp.GetIndex() });
+    return Base_t::template GetRequiredContainer<column_type<EntSig_t, Cmp_t>>();
   }
 
 private:
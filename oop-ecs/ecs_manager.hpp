@@ -1,16 +1,32 @@
 #pragma once
 
+#include "bitset.hpp"
 #include "component_manager.hpp"
 #include "ecs_map.hpp"
 #include "entity.hpp"
 #include "entity_manager.hpp"
+#include "job_system.hpp"
+#include "lifecycle.hpp"
+#include "snapshot.hpp"
+#include "stats.hpp"
+#include "storage.hpp"
 #include "struct_of_arrays.hpp"
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
 #include <cstdint>
 #include <execution>
+#include <limits>
+#include <numeric>
+#include <ranges>
+#include <span>
 #include <type_traits>
-#include <variant>
+#include <utility>
+#include <vector>
 
 namespace ECS {
 
@@ -19,35 +35,111 @@ template<class Config_t> struct ECSManager_t : Uncopyable_t
 private:
   template<class Sign_t> struct EntityConfig_t;
 
-  template<class... Ts> using BaseComponentContainer_t = SoA_t<ECSMap_t, Ts...>;
-  template<class... Ts> using BaseEntityContainer_t    = SoA_t<ECSMap_t, Entity_t<EntityConfig_t<Ts>>...>;
+public:
+  using allocator_type  = Traits::Allocator_t<Config_t, std::byte>;
+  using index_type      = Traits::Index_t<Config_t>;
+  using signatures_type = typename Config_t::Signatures_t;
+
+  template<class T> using handle_type = ECS::Handle_t<T, index_type>;
+  template<class T> using event_type  = LifecycleEvent_t<T, index_type>;
+
+private:
+  template<class T> using Handle_t     = handle_type<T>;
+  template<class T> using Map_t        = ECSMap_t<T, allocator_type, index_type>;
+  template<class T> using ColumnMap_t  = ECS::ColumnMap_t<T, allocator_type, index_type>;
+  template<class T> using EventQueue_t = LifecycleQueue_t<T, allocator_type, index_type>;
+
+  template<class... Ts> using BaseComponentContainer_t = SoA_t<Map_t, Ts...>;
+  template<class... Ts> using BaseColumnContainer_t    = SoA_t<ColumnMap_t, Ts...>;
+  template<class... Ts> using BaseEntityContainer_t    = SoA_t<Map_t, Entity_t<EntityConfig_t<Ts>>...>;
+
+  static constexpr auto IsArchetype_v{ Traits::IsArchetypeStorage_v<Config_t> };
+  static constexpr auto IsVirtualBases_v{ Traits::IsVirtualBases_v<Config_t> };
+  static constexpr auto IsTraced_v{ !std::is_same_v<Traits::Tracer_t<Config_t>, NoTracer_t> };
 
-  using EntitySignatures_t = typename Config_t::Signatures_t;
-  using ComponentList_t    = Seq::As_t<Traits::Components_t, EntitySignatures_t>;
+  // recorded by Config_t::Tracer_t when it goes out of scope, an empty object
+  // without tracer
+  using TraceScope_t = typename Traits::Tracer_t<Config_t>::Scope_t;
+
+  using EntitySignatures_t = signatures_type;
+  using ComponentList_t    = Seq::As_t<Traits::StoredComponents_t, EntitySignatures_t>;
+  using OptionalTags_t     = Traits::OptionalTags_t<Config_t>;
+  using ParentID_t         = ECS::ParentID_t<index_type, Seq::Size_v<EntitySignatures_t>>;
 
   template<class T> using ToID_t = std::type_identity<Handle_t<T>>;
 
-  struct ComponentManagerConfig_t
+  template<class T> using IsOptionalTag = std::bool_constant<Seq::Contains_v<T, OptionalTags_t>>;
+
+  // optional tags filtered out of a ForEachWith, tested on each row
+  template<class... Cmps_t>
+  using OptionalFilters_t =
+    Seq::Filter_t<typename Traits::Query<EntitySignatures_t, Cmps_t...>::Excluded_t, IsOptionalTag>;
+
+  // bases with a row of their own and link stored in the rows to their parent
+  template<class Sign_t>
+  using RowBases_t    = std::conditional_t<IsVirtualBases_v, TMPL::TypeList_t<>, Traits::Bases_t<Sign_t>>;
+  using RowParentID_t = std::conditional_t<IsVirtualBases_v, NoParentID_t, ParentID_t>;
+
+  template<class Sign_t> struct SignatureColumns_t
+  {
+    template<class T> using ToColumn_t = std::type_identity<Column_t<Sign_t, T>>;
+    using type =
+      Seq::Map_t<Seq::Cat_t<Traits::StoredComponents_t<Sign_t>, TMPL::TypeList_t<Handle_t<Sign_t>>>, ToColumn_t>;
+  };
+
+  using ColumnList_t = Seq::As_t<Seq::Cat_t, Seq::Map_t<EntitySignatures_t, SignatureColumns_t>>;
+
+  struct SharedComponentManagerConfig_t
+  {
+    using index_type                                      = ECSManager_t::index_type;
+    using base                                            = Seq::As_t<BaseComponentContainer_t, ComponentList_t>;
+    template<class Sign_t, class Cmp_t> using column_type = Cmp_t;
+  };
+
+  struct ArchetypeComponentManagerConfig_t
+  {
+    using index_type                                      = ECSManager_t::index_type;
+    using base                                            = Seq::As_t<BaseColumnContainer_t, ColumnList_t>;
+    template<class Sign_t, class Cmp_t> using column_type = Column_t<Sign_t, Cmp_t>;
+  };
+
+  using ComponentManagerConfig_t =
+    std::conditional_t<IsArchetype_v, ArchetypeComponentManagerConfig_t, SharedComponentManagerConfig_t>;
+
+  using ColumnTypes_t = std::conditional_t<IsArchetype_v, ColumnList_t, ComponentList_t>;
+
+  // rows to erase, flagged by position in each entity and component container
+  struct RowMarks_t
+  {
+    std::array<std::vector<bool>, Seq::Size_v<EntitySignatures_t>> mEntities{};
+    std::array<std::vector<bool>, Seq::Size_v<ColumnTypes_t>>      mColumns{};
+  };
+
+  // next entity row Defragment visits and the number of entities it placed
+  struct DefragCursor_t
   {
-    using base = Seq::As_t<BaseComponentContainer_t, ComponentList_t>;
+    std::size_t mRow{};
+    std::size_t mRank{};
   };
 
   template<class Sign_t> struct EntityConfig_t
   {
     template<class T> using Self_t      = EntityConfig_t<T>;
+    using index_type                    = ECSManager_t::index_type;
     using Signature_t                   = Sign_t;
     using Signatures_t                  = EntitySignatures_t;
-    using Components_t                  = Traits::Components_t<Signature_t>;
-    using Bases_t                       = Traits::Bases_t<Signature_t>;
+    using Components_t                  = Traits::StoredComponents_t<Signature_t>; // tags have no handle
+    using Bases_t                       = RowBases_t<Signature_t>;
     template<class T> using CanBeParent = std::bool_constant<Traits::IsInstanceOf_v<Signature_t, T>>;
-    using Parents_t                     = Seq::Map_t<Seq::Filter_t<Signatures_t, CanBeParent>, ToID_t>;
+    using Instances_t                   = Seq::Filter_t<Signatures_t, CanBeParent>;
     using ComponentIDs_t                = Seq::As_t<std::tuple, Seq::Map_t<Components_t, ToID_t>>;
     using BasesIDs_t                    = Seq::As_t<std::tuple, Seq::Map_t<Bases_t, ToID_t>>;
-    using ParentVariant_t               = Seq::As_t<std::variant, Parents_t>;
+    using ParentID_t                    = RowParentID_t;
   };
 
   struct EntityManagerConfig_t
   {
+    using index_type                    = ECSManager_t::index_type;
     using base                          = Seq::As_t<BaseEntityContainer_t, EntitySignatures_t>;
     template<class T> using entity_type = Entity_t<EntityConfig_t<T>>;
   };
@@ -55,120 +147,1035 @@ private:
   using ComponentMan_t = ComponentManager_t<ComponentManagerConfig_t>;
   using EntityMan_t    = EntityManager_t<EntityManagerConfig_t>;
 
+  template<class... Ts> struct BaseEventContainer_t : EventQueue_t<Ts>...
+  {
+    constexpr explicit BaseEventContainer_t(const allocator_type& alloc)
+      : EventQueue_t<Ts>{ alloc }...
+    {
+    }
+  };
+
+  using EventQueues_t = Seq::As_t<BaseEventContainer_t, EntitySignatures_t>;
+
+  // one bitset per signature and optional tag, indexed by entity key
+  using TagBits_t =
+    std::array<Bitset_t<allocator_type>, Seq::Size_v<EntitySignatures_t> * Seq::Size_v<OptionalTags_t>>;
+
+  template<std::size_t... Is>
+  constexpr static auto MakeTagBits(const allocator_type& alloc, std::index_sequence<Is...>) -> TagBits_t
+  {
+    return { ((void)Is, Bitset_t<allocator_type>{ alloc })... };
+  }
+
+  static constexpr std::uint32_t snapshot_magic{ 0x5343454f }; // "OECS"
+  static constexpr std::uint32_t snapshot_version{ 3 };
+
+  // fingerprint of everything that shapes the bytes of a snapshot
+  constexpr static auto SnapshotFingerprint() -> std::uint64_t
+  {
+    std::uint64_t hash{ 0xcbf29ce484222325 };
+    hash = SnapshotHash(hash, std::endian::native == std::endian::little);
+    hash = SnapshotLayout<index_type>(hash);
+    hash = SnapshotHash(hash, IsArchetype_v);
+    hash = SnapshotHash(hash, IsVirtualBases_v);
+    hash = SnapshotHash(hash, Seq::Size_v<OptionalTags_t>);
+    Seq::Unpacker_t<ColumnTypes_t>::Call([&]<class... Cols_t>() {
+      ((hash = SnapshotHash(SnapshotLayout<ColumnValue_t<Cols_t>>(hash), TracksChanges_v<ColumnValue_t<Cols_t>>)),
+       ...);
+    });
+    Seq::Unpacker_t<EntitySignatures_t>::Call([&]<class... Signs_t>() {
+      ((hash = SnapshotHash(hash, sizeof(entity_type<Signs_t>))), ...);
+    });
+    return hash;
+  }
+
 public:
   template<class T> using entity_type = typename EntityMan_t::template entity_type<T>;
 
   template<class T> using EntityID_t = typename EntityMan_t::template EntityID_t<T>;
 
+  constexpr explicit ECSManager_t(const allocator_type& alloc = allocator_type{})
+    : mComponentMan{ alloc }
+    , mEntityMan{ alloc }
+    , mEvents{ alloc }
+    , mTagBits{ MakeTagBits(alloc, std::make_index_sequence<std::tuple_size_v<TagBits_t>>{}) }
+  {
+  }
+
+  // concrete signatures whose entities are also entities of T
+  template<class T> using instances_type = typename EntityConfig_t<T>::Instances_t;
+
 private:
-  template<class SysSig_t, class EntSig_t, class Callback_t>
-  constexpr static auto ProcessEntity(Handle_t<EntSig_t> e, Callback_t cb, auto& ecs_man) -> void
+  // signatures with the entity rows to walk for the entities of T
+  template<class T>
+  using RowSignatures_t = std::conditional_t<IsVirtualBases_v, instances_type<T>, TMPL::TypeList_t<T>>;
+
+  template<class SysSig_t, class Callback_t>
+  constexpr static auto InvokeSystem(Callback_t cb, auto&& get_cmp, auto&& get_handle) -> decltype(auto)
   {
     using Cmps_t    = Traits::Components_t<SysSig_t>;
-    using EntHandle = std::conditional_t<std::is_same_v<SysSig_t, EntSig_t>, Handle_t<EntSig_t>, Handle_t<SysSig_t>>;
-    EntHandle ent_handle{ 0 };
+    using EntHandle = Handle_t<SysSig_t>;
+    if constexpr (Traits::IsInvocable_v<Callback_t, Cmps_t, EntHandle>) {
+      return Seq::Unpacker_t<Cmps_t>::Call(
+        [&]<class... Ts>(auto fn) { return fn(get_cmp.template operator()<Ts>()..., get_handle()); }, cb);
+    } else if constexpr (Traits::ConditionalIsInvocable_v<(Seq::Size_v<Cmps_t> > 1), Callback_t, Cmps_t>) {
+      return Seq::Unpacker_t<Cmps_t>::Call(
+        [&]<class... Ts>(auto fn) { return fn(get_cmp.template operator()<Ts>()...); }, cb);
+    } else if constexpr (Traits::IsInvocable_v<Callback_t, EntHandle>) {
+      return cb(get_handle());
+    }
+  }
+
+  // every tag of a type is the same const object
+  template<class Tag_t> constexpr static auto GetTag() -> const Tag_t& { return Traits::TagInstance<Tag_t>; }
+
+  // Calls fn with the row of the concrete entity e belongs to. The signature
+  // index of the parent link is compared with the instances of EntSig_t only,
+  // in order, fn is inlined in each branch. The last instance is taken
+  // without comparing, debug builds assert it is the one linked. With
+  // virtual bases the handle itself is the link.
+  template<class EntSig_t> constexpr static auto VisitParent(Handle_t<EntSig_t> e, auto& ecs_man, auto&& fn)
+    -> decltype(auto)
+  {
+    if constexpr (IsVirtualBases_v) {
+      return DispatchParent(instances_type<EntSig_t>{}, ParentID_t::FromWord(e.GetIndex()), fn);
+    } else {
+      return DispatchParent(instances_type<EntSig_t>{}, ecs_man.mEntityMan.GetEntity(e).GetParentID(), fn);
+    }
+  }
+
+  // handle of the entity with the parent row row seen as SysSig_t, with
+  // materialized bases the rows of Sign_t can also be base rows
+  template<class SysSig_t, class Sign_t>
+  constexpr static auto MakeHandle(Handle_t<Sign_t> row, auto& ecs_man) -> Handle_t<SysSig_t>
+  {
+    if constexpr (IsVirtualBases_v) {
+      return { ParentID_t{ Seq::IndexOf_v<Sign_t, EntitySignatures_t>, row.GetIndex() }.GetWord() };
+    } else if constexpr (std::is_same_v<SysSig_t, Sign_t>) {
+      return row;
+    } else {
+      return ecs_man.mEntityMan.GetEntity(row).template GetBaseID<SysSig_t>();
+    }
+  }
+
+  // row of the parent entity handle e
+  template<class EntSig_t> constexpr static auto GetRow(Handle_t<EntSig_t> e) -> Handle_t<EntSig_t>
+  {
+    if constexpr (IsVirtualBases_v) {
+      auto parent{ ParentID_t::FromWord(e.GetIndex()) };
+      assert(parent.GetSignature() == (Seq::IndexOf_v<EntSig_t, EntitySignatures_t>) && "Not a parent entity handle");
+      return { parent.GetRow() };
+    } else {
+      return e;
+    }
+  }
+
+  template<template<class...> class TList_t, class Sign_t, class... Signs_t>
+  constexpr static auto DispatchParent(TList_t<Sign_t, Signs_t...>, auto parent, auto& fn) -> decltype(auto)
+  {
+    if constexpr (sizeof...(Signs_t) == 0) {
+      assert(parent.GetSignature() == (Seq::IndexOf_v<Sign_t, EntitySignatures_t>) && "Stale or corrupt parent link");
+      return fn(Handle_t<Sign_t>{ parent.GetRow() });
+    } else {
+      if (parent.GetSignature() == Seq::IndexOf_v<Sign_t, EntitySignatures_t>) {
+        return fn(Handle_t<Sign_t>{ parent.GetRow() });
+      }
+      return DispatchParent(TList_t<Signs_t...>{}, parent, fn);
+    }
+  }
+
+  template<class Cmpt_t, class EntSig_t>
+  constexpr static auto FindComponent(Handle_t<EntSig_t> e, auto& ecs_man) -> auto&
+  {
+    static_assert(Seq::Contains_v<Cmpt_t, Traits::Components_t<EntSig_t>>, "This entity doesn't have this component");
+    if constexpr (Traits::IsTag_v<Cmpt_t>) {
+      return GetTag<Cmpt_t>();
+    } else if constexpr (!IsVirtualBases_v && (!IsArchetype_v || Seq::Size_v<instances_type<EntSig_t>> == 1)) {
+      auto& ent{ ecs_man.mEntityMan.GetEntity(e) };
+      return ecs_man.mComponentMan.template GetComponent<EntSig_t>(ent.template GetComponentID<Cmpt_t>());
+    } else {
+      // the component is found from the row of the concrete signature
+      return VisitParent<EntSig_t>(e, ecs_man, [&]<class T>(T eid) -> auto& {
+        auto& parent{ ecs_man.mEntityMan.GetEntity(eid) };
+        return ecs_man.mComponentMan.template GetComponent<typename T::type>(parent.template GetComponentID<Cmpt_t>());
+      });
+    }
+  }
+
+  template<class SysSig_t, class EntSig_t, class Callback_t>
+  constexpr static auto ProcessEntity(Handle_t<EntSig_t> e, Callback_t cb, auto& ecs_man) -> decltype(auto)
+  {
+    if constexpr (IsVirtualBases_v) {
+      return VisitParent<EntSig_t>(
+        e, ecs_man, [&]<class T>(T row) -> decltype(auto) { return ProcessParent<SysSig_t>(row, cb, ecs_man); });
+    } else {
+      return ProcessHandle<SysSig_t>(e, cb, ecs_man);
+    }
+  }
+
+  template<class SysSig_t, class EntSig_t, class Callback_t>
+  constexpr static auto ProcessHandle(Handle_t<EntSig_t> e, Callback_t cb, auto& ecs_man) -> decltype(auto)
+  {
+    Handle_t<SysSig_t> ent_handle{ 0 };
     if constexpr (std::is_same_v<SysSig_t, EntSig_t>) {
       ent_handle = e;
     } else {
       ent_handle = ecs_man.template GetBaseID<SysSig_t>(e);
     }
-    if constexpr (Traits::IsInvocable_v<Callback_t, Cmps_t, EntHandle>) {
-      Seq::Unpacker_t<Cmps_t>::Call(
-        [&]<class... Ts>(auto fn) { fn(ecs_man.template GetComponent<Ts>(ent_handle)..., ent_handle); }, cb);
-    } else if constexpr (Traits::ConditionalIsInvocable_v<(Seq::Size_v<Cmps_t> > 1), Callback_t, Cmps_t>) {
-      Seq::Unpacker_t<Cmps_t>::Call([&]<class... Ts>(auto fn) { fn(ecs_man.template GetComponent<Ts>(ent_handle)...); },
-                                    cb);
-    } else if constexpr (Traits::IsInvocable_v<Callback_t, EntHandle>) {
-      cb(ent_handle);
-    }
+    return InvokeSystem<SysSig_t>(
+      cb,
+      [&]<class Cmp_t>() -> decltype(auto) { return ecs_man.template GetComponent<Cmp_t>(ent_handle); },
+      [&]() { return ent_handle; });
+  }
+
+  // row is the key of an entity row of Sign_t, which must be concrete with
+  // archetype storage
+  template<class SysSig_t, class Sign_t, class Callback_t>
+  constexpr static auto ProcessParent(Handle_t<Sign_t> row, Callback_t cb, auto& ecs_man) -> decltype(auto)
+  {
+    auto& ent{ ecs_man.mEntityMan.GetEntity(row) };
+    return InvokeSystem<SysSig_t>(
+      cb,
+      [&]<class Cmp_t>() -> decltype(auto) {
+        if constexpr (Traits::IsTag_v<Cmp_t>) {
+          return GetTag<Cmp_t>();
+        } else {
+          return ecs_man.mComponentMan.template GetComponent<Sign_t>(ent.template GetComponentID<Cmp_t>());
+        }
+      },
+      [&]() { return MakeHandle<SysSig_t>(row, ecs_man); });
+  }
+
+  // pos is the row of the entity in every column of Sign_t
+  template<class SysSig_t, class Sign_t, class Callback_t>
+  constexpr static auto ProcessRow(std::size_t pos, Callback_t cb, auto& ecs_man) -> void
+  {
+    InvokeSystem<SysSig_t>(
+      cb,
+      [&]<class Cmp_t>() -> decltype(auto) {
+        if constexpr (Traits::IsTag_v<Cmp_t>) {
+          return GetTag<Cmp_t>();
+        } else {
+          return ecs_man.mComponentMan.template GetColumn<Sign_t, Cmp_t>().get_value(pos);
+        }
+      },
+      [&]() {
+        auto owner{ ecs_man.mComponentMan.template GetColumn<Sign_t, Handle_t<Sign_t>>().get_value(pos) };
+        return MakeHandle<SysSig_t>(owner, ecs_man);
+      });
   }
 
   template<class SysSig_t, class EntSig_t>
   constexpr static auto MatchEntity(Handle_t<EntSig_t> e, auto cb, auto& ecs_man) -> void
   {
+    TraceScope_t trace{ "Match", TypeName_v<SysSig_t>, 1 };
     if constexpr (Traits::IsInstanceOf_v<SysSig_t, EntSig_t>) {
       ProcessEntity<SysSig_t>(e, cb, ecs_man);
     } else {
-      std::visit(
-        [&]<class T>(T eid) {
-          if constexpr (Traits::IsInstanceOf_v<SysSig_t, typename T::type>) {
-            ProcessEntity<SysSig_t>(eid, cb, ecs_man);
-          }
-        },
-        ecs_man.mEntityMan.GetEntity(e).GetParentID());
+      VisitParent<EntSig_t>(e, ecs_man, [&]<class T>(T row) {
+        if constexpr (Traits::IsInstanceOf_v<SysSig_t, typename T::type>) {
+          ProcessParent<SysSig_t>(row, cb, ecs_man);
+        }
+      });
     }
   }
 
   template<class EntSig_t> constexpr static auto MatchEntity(auto& ecs_man, Handle_t<EntSig_t> e, auto... cbs) -> void
   {
-    std::visit(
-      [&]<class T>(T eid) {
-        overloaded fn{ cbs... };
-        ProcessEntity<typename T::type>(eid, fn, ecs_man);
-        Seq::ForEach_t<Traits::Bases_t<typename T::type>>::Do([&]<class Bs_t>() {
-          auto bs{ ecs_man.template GetBaseID<Bs_t>(eid) };
-          ProcessEntity<Bs_t>(bs, fn, ecs_man);
-        });
-      },
-      ecs_man.mEntityMan.GetEntity(e).GetParentID());
+    TraceScope_t trace{ "Match", TypeName_v<EntSig_t>, 1 };
+    VisitParent<EntSig_t>(e, ecs_man, [&]<class T>(T row) {
+      overloaded fn{ cbs... };
+      ProcessParent<typename T::type>(row, fn, ecs_man);
+      Seq::ForEach_t<Traits::Bases_t<typename T::type>>::Do(
+        [&]<class Bs_t>() { ProcessParent<Bs_t>(row, fn, ecs_man); });
+    });
+  }
+
+  // Calls fn with every position below count. The sequential loop goes from the
+  // last one, so the entity being visited can be destroyed or transformed.
+  constexpr static auto ForEachPosition(std::execution::sequenced_policy,
+                                        [[maybe_unused]] const auto& values,
+                                        std::size_t                  count,
+                                        auto&&                       fn) -> void
+  {
+    for (auto pos{ count }; pos-- > 0;) {
+      fn(pos);
+    }
+  }
+
+  constexpr static auto ForEachPosition(JobSystem_t&                 jobs,
+                                        [[maybe_unused]] const auto& values,
+                                        std::size_t                  count,
+                                        auto&&                       fn) -> void
+  {
+    jobs.ParallelFor(count, [&](std::size_t first, std::size_t last) {
+      for (auto pos{ first }; pos < last; ++pos) {
+        fn(pos);
+      }
+    });
+  }
+
+  template<class Policy_t>
+    requires std::is_execution_policy_v<std::remove_cvref_t<Policy_t>>
+  constexpr static auto ForEachPosition(Policy_t&& policy, const auto& values, std::size_t count, auto&& fn) -> void
+  {
+    std::for_each(policy, values.rend() - static_cast<std::ptrdiff_t>(count), values.rend(), [&](const auto& value) {
+      fn(static_cast<std::size_t>(std::addressof(value) - values.data()));
+    });
   }
 
   template<class EntSig_t> constexpr static auto TraverseEntities(auto&& policy, auto cb, auto& ecs_man) -> void
   {
-    std::for_each(policy,
-                  ecs_man.mEntityMan.template rbegin<entity_type<EntSig_t>>(),
-                  ecs_man.mEntityMan.template rend<entity_type<EntSig_t>>(),
-                  [&](auto& slot) { ProcessEntity<EntSig_t>(Handle_t{ slot.key() }, cb, ecs_man); });
+    using Policy_t = std::remove_cvref_t<decltype(policy)>;
+    TraceScope_t trace{ std::is_same_v<Policy_t, std::execution::sequenced_policy> ? "ForEach" : "ParallelForEach",
+                        TypeName_v<EntSig_t>,
+                        IsTraced_v ? ecs_man.template Size<EntSig_t>() : 0 };
+    if constexpr (IsArchetype_v) {
+      TraverseColumns<EntSig_t>(instances_type<EntSig_t>{}, policy, cb, ecs_man);
+    } else {
+      TraverseRows<EntSig_t>(RowSignatures_t<EntSig_t>{}, policy, cb, ecs_man);
+    }
   }
 
-  template<class Cmpt_t> constexpr auto CreateComponent(Cmpt_t&& cmp) -> auto
+  template<class SysSig_t, template<class...> class TList_t, class... Signs_t>
+  constexpr static auto TraverseRows(TList_t<Signs_t...>, auto&& policy, auto cb, auto& ecs_man) -> void
   {
-    return mComponentMan.template Create<Cmpt_t>(std::forward<Cmpt_t>(cmp));
+    std::size_t                                 i{};
+    std::array<std::size_t, sizeof...(Signs_t)> counts{ ecs_man.mEntityMan.template GetEntities<Signs_t>().size()... };
+    auto                                        traverse{ [&]<class Sign_t>(std::size_t count) {
+      auto& ents{ ecs_man.mEntityMan.template GetEntities<Sign_t>() };
+      ForEachPosition(policy, ents, count, [&](std::size_t pos) {
+        ProcessParent<SysSig_t>(ECS::Handle_t{ ents.get_key(pos) }, cb, ecs_man);
+      });
+    } };
+    (traverse.template operator()<Signs_t>(counts[i++]), ...);
   }
 
-  template<template<class...> class TList_t, class... Default_t, class... Cmps_t>
-  constexpr auto CreateComponents(TList_t<Default_t...>, Cmps_t&&... cmps) -> auto
+  // The row counts are taken before visiting any signature, so an entity
+  // transformed into a signature that is visited later is not processed twice.
+  template<class SysSig_t, template<class...> class TList_t, class... Signs_t>
+  constexpr static auto TraverseColumns(TList_t<Signs_t...>, auto&& policy, auto cb, auto& ecs_man) -> void
+  {
+    std::size_t                                 i{};
+    std::array<std::size_t, sizeof...(Signs_t)> counts{
+      ecs_man.mComponentMan.template GetColumn<Signs_t, Handle_t<Signs_t>>().size()...
+    };
+    (TraverseColumn<SysSig_t, Signs_t>(policy, cb, ecs_man, counts[i++]), ...);
+  }
+
+  template<class SysSig_t, class Sign_t>
+  constexpr static auto TraverseColumn(auto&& policy, auto cb, auto& ecs_man, std::size_t count) -> void
+  {
+    auto& owners{ ecs_man.mComponentMan.template GetColumn<Sign_t, Handle_t<Sign_t>>() };
+    ForEachPosition(policy, owners, count, [&](std::size_t pos) { ProcessRow<SysSig_t, Sign_t>(pos, cb, ecs_man); });
+  }
+
+  // Archetype columns are scanned against the tag bitset of their signature,
+  // with shared storage HasTag is checked for each row, or the bitset of the
+  // row signature directly with virtual bases.
+  template<class SysSig_t, class Tag_t, template<class...> class TList_t, class... Signs_t>
+  constexpr static auto TraverseTagged(TList_t<Signs_t...>, auto cb, auto& ecs_man) -> void
+  {
+    if constexpr (IsArchetype_v) {
+      std::size_t                                 i{};
+      std::array<std::size_t, sizeof...(Signs_t)> counts{
+        ecs_man.mComponentMan.template GetColumn<Signs_t, Handle_t<Signs_t>>().size()...
+      };
+      auto traverse{ [&]<class Sign_t>(std::size_t count) {
+        const auto& bits{ std::as_const(ecs_man).template GetTagBits<Sign_t, Tag_t>() };
+        const auto& owners{ std::as_const(ecs_man.mComponentMan).template GetColumn<Sign_t, Handle_t<Sign_t>>() };
+        for (auto pos{ count }; pos-- > 0;) {
+          if (bits.test(owners.get_value(pos).GetIndex())) {
+            ProcessRow<SysSig_t, Sign_t>(pos, cb, ecs_man);
+          }
+        }
+      } };
+      (traverse.template operator()<Signs_t>(counts[i++]), ...);
+    } else {
+      Seq::ForEach_t<RowSignatures_t<SysSig_t>>::Do([&]<class Sign_t>() {
+        const auto& ents{ std::as_const(ecs_man.mEntityMan).template GetEntities<Sign_t>() };
+        for (auto pos{ ents.size() }; pos-- > 0;) {
+          Handle_t<Sign_t> row{ ents.get_key(pos) };
+          if constexpr (IsVirtualBases_v) {
+            if (!std::as_const(ecs_man).template GetTagBits<Sign_t, Tag_t>().test(row.GetIndex())) {
+              continue;
+            }
+          } else if (!ecs_man.template HasTag<Tag_t>(row)) {
+            continue;
+          }
+          ProcessParent<SysSig_t>(row, cb, ecs_man);
+        }
+      });
+    }
+  }
+
+  // Archetype columns skip the chunks without newer versions, with shared
+  // storage the version of each entity is checked.
+  template<class SysSig_t, class Cmp_t, template<class...> class TList_t, class... Signs_t>
+  constexpr static auto TraverseChanged(TList_t<Signs_t...>, Version_t since, auto cb, auto& ecs_man) -> void
   {
-    return std::tuple{ CreateComponent(std::forward<Cmps_t>(cmps))..., CreateComponent(Default_t{})... };
+    static_assert(TracksChanges_v<Cmp_t>, "The component does not track its changes");
+    static_assert(Seq::Contains_v<Cmp_t, Traits::Components_t<SysSig_t>>, "This entity doesn't have this component");
+    if constexpr (IsArchetype_v) {
+      std::size_t                                 i{};
+      std::array<std::size_t, sizeof...(Signs_t)> counts{
+        ecs_man.mComponentMan.template GetColumn<Signs_t, Handle_t<Signs_t>>().size()...
+      };
+      auto traverse{ [&]<class Sign_t>(std::size_t count) {
+        const auto& column{ std::as_const(ecs_man.mComponentMan).template GetColumn<Sign_t, Cmp_t>() };
+        constexpr auto chunk_size{ std::remove_cvref_t<decltype(column)>::version_chunk_size };
+        for (auto chunk{ (count + chunk_size - 1) / chunk_size }; chunk-- > 0;) {
+          if (column.get_chunk_version(chunk) <= since) {
+            continue;
+          }
+          for (auto pos{ std::min(count, (chunk + 1) * chunk_size) }; pos-- > chunk * chunk_size;) {
+            if (column.get_version(pos) > since) {
+              ProcessRow<SysSig_t, Sign_t>(pos, cb, ecs_man);
+            }
+          }
+        }
+      } };
+      (traverse.template operator()<Signs_t>(counts[i++]), ...);
+    } else {
+      Seq::ForEach_t<RowSignatures_t<SysSig_t>>::Do([&]<class Sign_t>() {
+        const auto& ents{ std::as_const(ecs_man.mEntityMan).template GetEntities<Sign_t>() };
+        const auto& column{ std::as_const(ecs_man.mComponentMan).template GetColumn<Sign_t, Cmp_t>() };
+        for (auto pos{ ents.size() }; pos-- > 0;) {
+          auto cmp{ ents.get_value(pos).template GetComponentID<Cmp_t>() };
+          if (column.get_version(column.get_pos(cmp.GetIndex())) > since) {
+            ProcessParent<SysSig_t>(ECS::Handle_t{ ents.get_key(pos) }, cb, ecs_man);
+          }
+        }
+      });
+    }
   }
 
+  // calls cb with the components of an entity, and its handle when cb takes it
   template<template<class...> class TList_t, class... Cmps_t>
+  constexpr static auto InvokeWith(TList_t<Cmps_t...>, auto& cb, auto&& get_cmp, auto&& get_handle) -> void
+  {
+    if constexpr (std::is_invocable_v<decltype(cb),
+                                      decltype(get_cmp.template operator()<Cmps_t>())...,
+                                      decltype(get_handle())>) {
+      cb(get_cmp.template operator()<Cmps_t>()..., get_handle());
+    } else {
+      cb(get_cmp.template operator()<Cmps_t>()...);
+    }
+  }
+
+  // Walks the rows of each concrete signature. With materialized bases the
+  // base rows are skipped, their entities are visited from their own
+  // signature, which matches as well. The rows with any of the optional tags
+  // Filters_t are skipped too.
+  template<class Cmps_t, class Filters_t, template<class...> class TList_t, class... Signs_t>
+  constexpr static auto TraverseWith(TList_t<Signs_t...>, auto cb, auto& ecs_man) -> void
+  {
+    auto filtered{ [&]<class Sign_t>(Handle_t<Sign_t> row) {
+      return Seq::Unpacker_t<Filters_t>::Call([&]<class... Tags_t>() {
+        return (std::as_const(ecs_man).template GetTagBits<Sign_t, Tags_t>().test(row.GetIndex()) || ...);
+      });
+    } };
+    auto rows{ [&]<class Sign_t>() -> std::size_t {
+      if constexpr (IsArchetype_v) {
+        return ecs_man.mComponentMan.template GetColumn<Sign_t, Handle_t<Sign_t>>().size();
+      } else {
+        return ecs_man.mEntityMan.template GetEntities<Sign_t>().size();
+      }
+    } };
+    std::size_t                                 i{};
+    std::array<std::size_t, sizeof...(Signs_t)> counts{ rows.template operator()<Signs_t>()... };
+    TraceScope_t                                trace{
+      "ForEachWith", TypeName_v<Cmps_t>, IsTraced_v ? std::accumulate(counts.begin(), counts.end(), std::size_t{}) : 0
+    };
+
+    auto traverse{ [&]<class Sign_t>(std::size_t count) {
+      auto get_tag{ [&]<class Cmp_t>() -> auto& { return GetTag<Cmp_t>(); } };
+      if constexpr (IsArchetype_v) {
+        const auto& owners{ std::as_const(ecs_man.mComponentMan).template GetColumn<Sign_t, Handle_t<Sign_t>>() };
+        for (auto pos{ count }; pos-- > 0;) {
+          Handle_t<Sign_t> owner{ owners.get_value(pos) };
+          if (filtered.template operator()<Sign_t>(owner)) {
+            continue;
+          }
+          InvokeWith(
+            Cmps_t{},
+            cb,
+            [&]<class Cmp_t>() -> decltype(auto) {
+              if constexpr (Traits::IsTag_v<Cmp_t>) {
+                return get_tag.template operator()<Cmp_t>();
+              } else {
+                return ecs_man.mComponentMan.template GetColumn<Sign_t, Cmp_t>().get_value(pos);
+              }
+            },
+            [&]() { return MakeHandle<Sign_t>(owner, ecs_man); });
+        }
+      } else {
+        const auto& ents{ std::as_const(ecs_man.mEntityMan).template GetEntities<Sign_t>() };
+        for (auto pos{ count }; pos-- > 0;) {
+          const auto& ent{ ents.get_value(pos) };
+          if constexpr (!IsVirtualBases_v && Seq::Size_v<instances_type<Sign_t>> > 1) {
+            if (ent.GetParentID().GetSignature() != Seq::IndexOf_v<Sign_t, EntitySignatures_t>) {
+              continue;
+            }
+          }
+          Handle_t<Sign_t> row{ ents.get_key(pos) };
+          if (filtered.template operator()<Sign_t>(row)) {
+            continue;
+          }
+          InvokeWith(
+            Cmps_t{},
+            cb,
+            [&]<class Cmp_t>() -> decltype(auto) {
+              if constexpr (Traits::IsTag_v<Cmp_t>) {
+                return get_tag.template operator()<Cmp_t>();
+              } else {
+                return ecs_man.mComponentMan.template GetComponent<Sign_t>(ent.template GetComponentID<Cmp_t>());
+              }
+            },
+            [&]() { return MakeHandle<Sign_t>(row, ecs_man); });
+        }
+      }
+    } };
+    (traverse.template operator()<Signs_t>(counts[i++]), ...);
+  }
+
+  // records a change of the values handed out by a mutable traversal
+  constexpr static auto Touch(auto& column, std::size_t pos, std::size_t count) -> void
+  {
+    if constexpr (!std::is_const_v<std::remove_reference_t<decltype(column)>>) {
+      column.touch(pos, count);
+    }
+  }
+
+  // Archetype columns are split only where a paged column changes page. With
+  // shared storage a run grows while the components of the next entity follow
+  // the ones of the previous in every map, as happens for entities created in
+  // a batch.
+  template<class SysSig_t, template<class...> class TList_t, class... Cmps_t>
+  constexpr static auto TraverseChunks(TList_t<Cmps_t...>, auto cb, auto& ecs_man) -> void
+  {
+    if constexpr (IsArchetype_v) {
+      Seq::ForEach_t<instances_type<SysSig_t>>::Do([&]<class Sign_t>() {
+        auto col{ [&]<class Cmp_t>() -> auto& {
+          return ecs_man.mComponentMan.template GetColumn<Sign_t, Cmp_t>();
+        } };
+        auto count{ col.template operator()<Handle_t<Sign_t>>().size() };
+        for (std::size_t pos{}, len{}; pos < count; pos += len) {
+          len = std::min({ count - pos, col.template operator()<Cmps_t>().contiguous_size(pos)... });
+          (Touch(col.template operator()<Cmps_t>(), pos, len), ...);
+          cb(std::span{ std::addressof(col.template operator()<Cmps_t>().get_value(pos)), len }...);
+        }
+      });
+    } else {
+      Seq::ForEach_t<RowSignatures_t<SysSig_t>>::Do(
+        [&]<class Sign_t>() { TraverseRowChunks<Sign_t>(TList_t<Cmps_t...>{}, cb, ecs_man); });
+    }
+  }
+
+  template<class Sign_t, template<class...> class TList_t, class... Cmps_t>
+  constexpr static auto TraverseRowChunks(TList_t<Cmps_t...>, auto cb, auto& ecs_man) -> void
+  {
+    auto& ents{ ecs_man.mEntityMan.template GetEntities<Sign_t>() };
+    auto  col{ [&]<class Cmp_t>() -> auto& {
+      return ecs_man.mComponentMan.template GetColumn<Sign_t, Cmp_t>();
+    } };
+    auto  get_pos{ [&]<class Cmp_t>(std::size_t pos) {
+      return col.template operator()<Cmp_t>().get_pos(
+        ents.get_value(pos).template GetComponentID<Cmp_t>().GetIndex());
+    } };
+    for (std::size_t pos{}, len{}; pos < ents.size(); pos += len) {
+      std::array<std::size_t, sizeof...(Cmps_t)> firsts{ get_pos.template operator()<Cmps_t>(pos)... };
+      auto at{ [&]<class Cmp_t>() { return firsts[TMPL::IndexOf_v<Cmp_t, Cmps_t...>]; } };
+      auto limit{ ents.size() - pos };
+      ((limit = std::min(limit, col.template operator()<Cmps_t>().contiguous_size(at.template operator()<Cmps_t>()))),
+       ...);
+      len = 1;
+      while (len < limit &&
+             ((get_pos.template operator()<Cmps_t>(pos + len) == at.template operator()<Cmps_t>() + len) && ...)) {
+        ++len;
+      }
+      (Touch(col.template operator()<Cmps_t>(), at.template operator()<Cmps_t>(), len), ...);
+      cb(std::span{ std::addressof(col.template operator()<Cmps_t>().get_value(at.template operator()<Cmps_t>())),
+                    len }...);
+    }
+  }
+
+  template<class EntSig_t, class Cmpt_t> constexpr auto CreateComponent(Cmpt_t&& cmp) -> auto
+  {
+    return mComponentMan.template Create<EntSig_t>(std::forward<Cmpt_t>(cmp));
+  }
+
+  template<class EntSig_t, template<class...> class TList_t, class... Default_t, class... Cmps_t>
+  constexpr auto CreateComponents(TList_t<Default_t...>, Cmps_t&&... cmps) -> auto
+  {
+    return std::tuple{ CreateComponent<EntSig_t>(std::forward<Cmps_t>(cmps))...,
+                       CreateComponent<EntSig_t>(Default_t{})... };
+  }
+
+  // moves the components kept by a TransformTo into the columns of DestSig_t
+  template<class DestSig_t, class SrcSig_t, template<class...> class TList_t, class... Cmps_t>
+  constexpr auto MoveComponents(TList_t<Cmps_t...>, [[maybe_unused]] const auto& e) -> auto
+  {
+    return std::tuple{ CreateComponent<DestSig_t>(
+      std::move(mComponentMan.template GetComponent<SrcSig_t>(e.template GetComponentID<Cmps_t>())))... };
+  }
+
+  template<class EntSig_t, template<class...> class TList_t, class... Cmps_t>
   constexpr auto DestroyComponents(TList_t<Cmps_t...>, [[maybe_unused]] const auto& e) -> void
   {
-    (mComponentMan.Destroy(e.template GetComponentID<Cmps_t>()), ...);
+    (mComponentMan.template Destroy<EntSig_t>(e.template GetComponentID<Cmps_t>()), ...);
+  }
+
+  // all the columns of a signature share the keys, so the row of an entity is
+  // the key of any of its components
+  template<class EntSig_t> constexpr static auto GetRowID(const auto& e) -> Handle_t<Handle_t<EntSig_t>>
+  {
+    using Cmps_t = Traits::StoredComponents_t<EntSig_t>;
+    static_assert(Seq::Size_v<Cmps_t> > 0, "Archetype storage requires at least one non tag component per signature.");
+    return { std::get<0>(e.GetComponentIDs()).GetIndex() };
+  }
+
+  template<class EntSig_t> constexpr auto DestroyRow(const auto& e) -> void
+  {
+    DestroyComponents<EntSig_t>(Traits::StoredComponents_t<EntSig_t>{}, e);
+    if constexpr (IsArchetype_v) {
+      mComponentMan.template Destroy<EntSig_t>(GetRowID<EntSig_t>(e));
+    }
+  }
+
+  template<class EntSig_t> constexpr auto GetEventQueue() const -> const EventQueue_t<EntSig_t>&
+  {
+    return mEvents;
+  }
+
+  template<class EntSig_t> constexpr auto GetEventQueue() -> EventQueue_t<EntSig_t>& { return mEvents; }
+
+  // an image reader lends its arrays to the maps, the tag bits are copied
+  template<class Reader_t> constexpr auto LoadContainers(Reader_t& in) -> void
+  {
+    if constexpr (std::is_same_v<Reader_t, ImageReader_t>) {
+      Seq::ForEach_t<ColumnTypes_t>::Do([&]<class Col_t>() { mComponentMan.template Borrow<Col_t>(in); });
+      Seq::ForEach_t<EntitySignatures_t>::Do([&]<class Sign_t>() { mEntityMan.template Borrow<Sign_t>(in); });
+    } else {
+      Seq::ForEach_t<ColumnTypes_t>::Do([&]<class Col_t>() { mComponentMan.template Load<Col_t>(in); });
+      Seq::ForEach_t<EntitySignatures_t>::Do([&]<class Sign_t>() { mEntityMan.template Load<Sign_t>(in); });
+    }
+    for (auto& bits : mTagBits) {
+      bits.load(in);
+    }
+  }
+
+  template<class Reader_t> constexpr auto LoadWorld(Reader_t& in) -> bool
+  {
+    if (in.template Read<std::uint32_t>() != snapshot_magic || in.template Read<std::uint32_t>() != snapshot_version ||
+        in.template Read<std::uint64_t>() != SnapshotFingerprint()) {
+      in.Fail();
+    }
+    LoadContainers(in);
+    for (auto& cursor : mDefragCursors) {
+      cursor.mRow  = static_cast<std::size_t>(in.template Read<std::uint64_t>());
+      cursor.mRank = static_cast<std::size_t>(in.template Read<std::uint64_t>());
+    }
+    mVersion = in.template Read<Version_t>();
+    if (in.Failed()) {
+      // a failed reader empties every container
+      LoadContainers(in);
+      mDefragCursors = {};
+      mVersion       = 1;
+    }
+    Seq::ForEach_t<ColumnTypes_t>::Do([&]<class Col_t>() { mComponentMan.template SetVersion<Col_t>(mVersion); });
+    Seq::ForEach_t<EntitySignatures_t>::Do([&]<class Sign_t>() { this->template GetEventQueue<Sign_t>().Clear(); });
+    return !in.Failed();
+  }
+
+  template<class EntSig_t> constexpr auto IsObserved() const -> bool
+  {
+    return Seq::Unpacker_t<Seq::Cat_t<TMPL::TypeList_t<EntSig_t>, Traits::Bases_t<EntSig_t>>>::Call(
+      [&]<class... Signs_t>() { return (GetEventQueue<Signs_t>().IsObserved() || ...); });
+  }
+
+  // records kind for the parent entity row e and for each of its bases
+  template<class EntSig_t> constexpr auto Notify(Handle_t<EntSig_t> e, Lifecycle_t kind) -> void
+  {
+    if (!IsObserved<EntSig_t>()) {
+      return;
+    }
+    GetEventQueue<EntSig_t>().Push(MakeHandle<EntSig_t>(e, *this), kind);
+    Seq::ForEach_t<Traits::Bases_t<EntSig_t>>::Do([&]<class Bs_t>() {
+      this->template GetEventQueue<Bs_t>().Push(this->template MakeHandle<Bs_t>(e, *this), kind);
+    });
+  }
+
+  template<class EntSig_t, class Tag_t> constexpr auto GetTagBits() const -> const Bitset_t<allocator_type>&
+  {
+    static_assert(Seq::Contains_v<Tag_t, OptionalTags_t>, "The tag is not listed in Config_t::OptionalTags_t");
+    return mTagBits[Seq::IndexOf_v<EntSig_t, EntitySignatures_t> * Seq::Size_v<OptionalTags_t> +
+                    Seq::IndexOf_v<Tag_t, OptionalTags_t>];
+  }
+
+  template<class EntSig_t, class Tag_t> constexpr auto GetTagBits() -> Bitset_t<allocator_type>&
+  {
+    return SameAsConstMemFunc(*this, &ECSManager_t::GetTagBits<EntSig_t, Tag_t>);
+  }
+
+  // the optional tags are kept on the parent entity
+  template<class EntSig_t> constexpr auto ClearTags(Handle_t<EntSig_t> e) -> void
+  {
+    Seq::ForEach_t<OptionalTags_t>::Do(
+      [&]<class Tag_t>() { this->template GetTagBits<EntSig_t, Tag_t>().reset(e.GetIndex()); });
+  }
+
+  template<class SrcSig_t, class DestSig_t> constexpr auto MoveTags(Handle_t<SrcSig_t> src, Handle_t<DestSig_t> dest)
+    -> void
+  {
+    Seq::ForEach_t<OptionalTags_t>::Do([&]<class Tag_t>() {
+      auto& src_bits{ this->template GetTagBits<SrcSig_t, Tag_t>() };
+      if (src_bits.test(src.GetIndex())) {
+        src_bits.reset(src.GetIndex());
+        this->template GetTagBits<DestSig_t, Tag_t>().set(dest.GetIndex());
+      }
+    });
+  }
+
+  // records kind for EntSig_t and for its bases that are not shared with
+  // OtherSig_t, the rows left or entered by a transformation
+  template<class EntSig_t, class OtherSig_t>
+  constexpr auto NotifyTransform(Handle_t<EntSig_t> e, Lifecycle_t kind) -> void
+  {
+    if (!IsObserved<EntSig_t>()) {
+      return;
+    }
+    GetEventQueue<EntSig_t>().Push(MakeHandle<EntSig_t>(e, *this), kind);
+    Seq::ForEach_t<Seq::Difference_t<Traits::Bases_t<EntSig_t>, Traits::Bases_t<OtherSig_t>>>::Do([&]<class Bs_t>() {
+      this->template GetEventQueue<Bs_t>().Push(this->template MakeHandle<Bs_t>(e, *this), kind);
+    });
+  }
+
+  template<class EntSig_t> constexpr auto CreateOwner(Handle_t<EntSig_t> e) -> void
+  {
+    if constexpr (IsArchetype_v) {
+      mComponentMan.template Create<EntSig_t>(e);
+    }
+  }
+
+  constexpr static auto Mark(std::vector<bool>& marks, const auto& container, std::size_t pos) -> void
+  {
+    if (marks.empty()) {
+      marks.resize(container.size());
+    }
+    marks[pos] = true;
+  }
+
+  template<class EntSig_t, class Cmp_t> constexpr auto MarkColumn(RowMarks_t& marks, Handle_t<Cmp_t> cmp) const -> void
+  {
+    using Col_t = typename ComponentMan_t::template column_type<EntSig_t, Cmp_t>;
+    const auto& column{ mComponentMan.template GetColumn<EntSig_t, Cmp_t>() };
+    Mark(marks.mColumns[Seq::IndexOf_v<Col_t, ColumnTypes_t>], column, column.get_pos(cmp.GetIndex()));
+  }
+
+  template<class EntSig_t> constexpr auto MarkRow(RowMarks_t& marks, Handle_t<EntSig_t> e) const -> void
+  {
+    const auto& ents{ mEntityMan.template GetEntities<EntSig_t>() };
+    Mark(marks.mEntities[Seq::IndexOf_v<EntSig_t, EntitySignatures_t>], ents, ents.get_pos(e.GetIndex()));
+  }
+
+  template<class EntSig_t> constexpr auto IsMarked(const RowMarks_t& marks, Handle_t<EntSig_t> e) const -> bool
+  {
+    const auto& ent_marks{ marks.mEntities[Seq::IndexOf_v<EntSig_t, EntitySignatures_t>] };
+    return !ent_marks.empty() && ent_marks[mEntityMan.template GetEntities<EntSig_t>().get_pos(e.GetIndex())];
+  }
+
+  // only call on the parent entity id
+  template<class EntSig_t> constexpr auto MarkEntity(RowMarks_t& marks, Handle_t<EntSig_t> e) const -> void
+  {
+    const auto& ent{ mEntityMan.GetEntity(e) };
+    MarkRow(marks, e);
+    Seq::ForEach_t<RowBases_t<EntSig_t>>::Do(
+      [&]<class Bs_t>() { this->MarkRow(marks, ent.template GetBaseID<Bs_t>()); });
+    Seq::ForEach_t<Traits::StoredComponents_t<EntSig_t>>::Do(
+      [&]<class Cmp_t>() { this->template MarkColumn<EntSig_t>(marks, ent.template GetComponentID<Cmp_t>()); });
+    if constexpr (IsArchetype_v) {
+      MarkColumn<EntSig_t>(marks, GetRowID<EntSig_t>(ent));
+    }
+  }
+
+  constexpr auto EraseMarked(const RowMarks_t& marks, Compaction_t compaction) -> void
+  {
+    Seq::ForEach_t<EntitySignatures_t>::Do([&]<class T>() {
+      const auto& ent_marks{ marks.mEntities[Seq::IndexOf_v<T, EntitySignatures_t>] };
+      if (!ent_marks.empty()) {
+        mEntityMan.template EraseMarked<T>(ent_marks, compaction);
+      }
+    });
+    Seq::ForEach_t<ColumnTypes_t>::Do([&]<class Col_t>() {
+      const auto& col_marks{ marks.mColumns[Seq::IndexOf_v<Col_t, ColumnTypes_t>] };
+      if (!col_marks.empty()) {
+        mComponentMan.template EraseMarked<Col_t>(col_marks, compaction);
+      }
+    });
+  }
+
+  // number of entities whose concrete signature is Sign_t, the rows of the
+  // descendants are not counted with materialized bases
+  template<class Sign_t> constexpr auto ConcreteSize() const -> std::size_t
+  {
+    auto rows{ mEntityMan.template size<entity_type<Sign_t>>() };
+    if constexpr (!IsVirtualBases_v) {
+      Seq::ForEach_t<Seq::Difference_t<instances_type<Sign_t>, TMPL::TypeList_t<Sign_t>>>::Do(
+        [&]<class Inst_t>() { rows -= this->template ConcreteSize<Inst_t>(); });
+    }
+    return rows;
+  }
+
+  // start of the range of the shared map of Cmp_t given to the entities of
+  // EntSig_t, after those of the signatures listed before it holding Cmp_t
+  template<class EntSig_t, class Cmp_t> constexpr auto DefragmentBase() const -> std::size_t
+  {
+    std::size_t base{};
+    Seq::ForEach_t<EntitySignatures_t>::Do([&]<class Sign_t>() {
+      if constexpr (Seq::IndexOf_v<Sign_t, EntitySignatures_t> < Seq::IndexOf_v<EntSig_t, EntitySignatures_t> &&
+                    Seq::Contains_v<Cmp_t, Traits::StoredComponents_t<Sign_t>>) {
+        base += this->template ConcreteSize<Sign_t>();
+      }
+    });
+    return base;
+  }
+
+  // Moves the components of the entities of EntSig_t in the next budget
+  // entity rows to the range of EntSig_t, in row order, starting where the
+  // previous call stopped. Base rows are skipped, their components belong to
+  // the range of their parent. Keys do not change, so the handles stay valid.
+  template<class EntSig_t, template<class...> class TList_t, class... Cmps_t>
+  constexpr auto DefragmentRows(TList_t<Cmps_t...>, std::size_t budget) -> std::size_t
+  {
+    auto& ents{ mEntityMan.template GetEntities<EntSig_t>() };
+    auto& cursor{ mDefragCursors[Seq::IndexOf_v<EntSig_t, EntitySignatures_t>] };
+    if (cursor.mRow >= ents.size()) {
+      cursor = {};
+    }
+    const std::array<std::size_t, sizeof...(Cmps_t)> bases{ DefragmentBase<EntSig_t, Cmps_t>()... };
+    const auto                                       count{ ConcreteSize<EntSig_t>() };
+
+    std::size_t moved{};
+    auto        place{ [&]<class Cmp_t>(const auto& ent) {
+      auto& column{ mComponentMan.template GetColumn<EntSig_t, Cmp_t>() };
+      auto  pos{ column.get_pos(ent.template GetComponentID<Cmp_t>().GetIndex()) };
+      auto  target{ bases[Seq::IndexOf_v<Cmp_t, TMPL::TypeList_t<Cmps_t...>>] + cursor.mRank };
+      if (pos != target) {
+        column.swap_values(pos, target);
+        ++moved;
+      }
+    } };
+    for (auto last{ cursor.mRow + std::min(budget, ents.size() - cursor.mRow) }; cursor.mRow < last; ++cursor.mRow) {
+      const auto& ent{ ents.get_value(cursor.mRow) };
+      if constexpr (!IsVirtualBases_v && Seq::Size_v<instances_type<EntSig_t>> > 1) {
+        if (ent.GetParentID().GetSignature() != Seq::IndexOf_v<EntSig_t, EntitySignatures_t>) {
+          continue;
+        }
+      }
+      // a rank left stale by entities destroyed since the previous call waits
+      // for the next pass
+      if (cursor.mRank < count) {
+        (place.template operator()<Cmps_t>(ent), ...);
+        ++cursor.mRank;
+      }
+    }
+    if (cursor.mRow == ents.size()) {
+      cursor = {};
+    }
+    return moved;
+  }
+
+  // breaks between the rows 1, 1 + stride, ... and the row before each
+  template<class EntSig_t, template<class...> class TList_t, class... Cmps_t>
+  constexpr auto CountRunBreaks(TList_t<Cmps_t...>, std::size_t stride) const -> std::size_t
+  {
+    const auto& ents{ mEntityMan.template GetEntities<EntSig_t>() };
+    auto        get_pos{ [&]<class Cmp_t>(std::size_t row) {
+      return mComponentMan.template GetColumn<EntSig_t, Cmp_t>().get_pos(
+        ents.get_value(row).template GetComponentID<Cmp_t>().GetIndex());
+    } };
+    std::size_t breaks{};
+    for (std::size_t row{ 1 }; row < ents.size(); row += stride) {
+      if (((get_pos.template operator()<Cmps_t>(row) != get_pos.template operator()<Cmps_t>(row - 1) + 1) || ...)) {
+        ++breaks;
+      }
+    }
+    return breaks;
+  }
+
+  // Disorder over at most samples pairs of rows evenly spread, all of them
+  // when there are fewer
+  template<class EntSig_t> constexpr auto SampleDisorder(std::size_t samples) const -> double
+  {
+    if constexpr (IsArchetype_v) {
+      return 0;
+    } else {
+      auto rows{ mEntityMan.template size<entity_type<EntSig_t>>() };
+      if (rows < 2 || samples == 0) {
+        return 0;
+      }
+      auto stride{ std::max((rows - 1) / samples, std::size_t{ 1 }) };
+      auto breaks{ CountRunBreaks<EntSig_t>(Traits::StoredComponents_t<EntSig_t>{}, stride) };
+      return static_cast<double>(breaks) / static_cast<double>((rows - 2) / stride + 1);
+    }
+  }
+
+  template<class EntSig_t, class... Args_t> constexpr static auto CheckComponentArgs() -> void
+  {
+    using ArgsTypes_t = TMPL::TypeList_t<std::remove_cvref_t<Args_t>...>;
+    static_assert(Seq::IsSet_v<ArgsTypes_t>, "Component arguments must be unique.");
+    static_assert(!(Traits::IsTag_v<std::remove_cvref_t<Args_t>> || ...), "Tags carry no data, do not pass them.");
+    static_assert(Seq::IsSubsetOf_v<ArgsTypes_t, Traits::Components_t<EntSig_t>>,
+                  "Components arguments does not match the entity components");
+  }
+
+  // fill_columns appends count components to every column of EntSig_t, then
+  // the entities are created from the keys found at the appended positions
+  template<class EntSig_t, template<class...> class TList_t, class... Cmps_t>
+  constexpr auto CreateEntities(TList_t<Cmps_t...>, std::size_t count, auto fill_columns)
+    -> std::vector<Handle_t<EntSig_t>>
+  {
+    TraceScope_t trace{ "CreateEntities", TypeName_v<EntSig_t>, count };
+    Reserve<EntSig_t>(count);
+    std::array<std::size_t, sizeof...(Cmps_t)> firsts{ mComponentMan.template GetColumn<EntSig_t, Cmps_t>().size()... };
+    fill_columns();
+
+    std::vector<Handle_t<EntSig_t>> ents{};
+    ents.reserve(count);
+    for (std::size_t i{}; i < count; ++i) {
+      std::tuple cmp_ids{ ECS::Handle_t{ mComponentMan.template GetColumn<EntSig_t, Cmps_t>().get_key(
+        firsts[TMPL::IndexOf_v<Cmps_t, Cmps_t...>] + i) }... };
+      auto e{ mEntityMan.template Create<EntSig_t>(cmp_ids) };
+      CreateOwner(e);
+      Notify(e, Lifecycle_t::Created);
+      ents.emplace_back(MakeHandle<EntSig_t>(e, *this));
+    }
+
+    return ents;
   }
 
 public:
   template<class EntSig_t, class... Args_t> constexpr auto CreateEntity(Args_t&&... args) -> Handle_t<EntSig_t>
   {
     using ArgsTypes_t           = TMPL::TypeList_t<std::remove_cvref_t<Args_t>...>;
-    using RequiredComponents_t  = Traits::Components_t<EntSig_t>;
-    using RemainingComponents_t = Seq::Difference_t<RequiredComponents_t, ArgsTypes_t>;
-    static_assert(Seq::IsSet_v<ArgsTypes_t>, "Component arguments must be unique.");
-    static_assert(Seq::IsSubsetOf_v<ArgsTypes_t, RequiredComponents_t>,
-                  "Components arguments does not match the entity components");
+    using RemainingComponents_t = Seq::Difference_t<Traits::StoredComponents_t<EntSig_t>, ArgsTypes_t>;
+    CheckComponentArgs<EntSig_t, Args_t...>();
+    TraceScope_t trace{ "CreateEntity", TypeName_v<EntSig_t>, 1 };
 
-    auto cmp_ids{ CreateComponents(RemainingComponents_t{}, std::forward<Args_t>(args)...) };
+    auto cmp_ids{ CreateComponents<EntSig_t>(RemainingComponents_t{}, std::forward<Args_t>(args)...) };
+    auto e{ mEntityMan.template Create<EntSig_t>(cmp_ids) };
+    CreateOwner(e);
+    Notify(e, Lifecycle_t::Created);
 
-    return { mEntityMan.template Create<EntSig_t>(cmp_ids) };
+    return MakeHandle<EntSig_t>(e, *this);
+  }
+
+  // Creates count entities at once. gen is called with the index of each new
+  // entity and returns a tuple with some of its components, the missing ones
+  // are default constructed.
+  template<class EntSig_t, std::invocable<std::size_t> Gen_t>
+  constexpr auto CreateEntities(std::size_t count, Gen_t gen) -> std::vector<Handle_t<EntSig_t>>
+  {
+    using Cmps_t = Traits::StoredComponents_t<EntSig_t>;
+    return CreateEntities<EntSig_t>(Cmps_t{}, count, [&] {
+      for (std::size_t i{}; i < count; ++i) {
+        std::apply(
+          [&]<class... Args_t>(Args_t&&... args) {
+            using ArgsTypes_t = TMPL::TypeList_t<std::remove_cvref_t<Args_t>...>;
+            CheckComponentArgs<EntSig_t, Args_t...>();
+            CreateComponents<EntSig_t>(Seq::Difference_t<Cmps_t, ArgsTypes_t>{}, std::forward<Args_t>(args)...);
+          },
+          gen(i));
+      }
+    });
+  }
+
+  // Creates count entities at once taking their components from one random
+  // access range per component type, the missing ones are default constructed.
+  template<class EntSig_t, std::ranges::random_access_range... Rngs_t>
+  constexpr auto CreateEntities(std::size_t count, Rngs_t&&... rngs) -> std::vector<Handle_t<EntSig_t>>
+  {
+    using Cmps_t      = Traits::StoredComponents_t<EntSig_t>;
+    using ArgsTypes_t = TMPL::TypeList_t<std::ranges::range_value_t<Rngs_t>...>;
+    CheckComponentArgs<EntSig_t, std::ranges::range_value_t<Rngs_t>...>();
+
+    return CreateEntities<EntSig_t>(Cmps_t{}, count, [&] {
+      auto fill_column{ [&](auto&& make_cmp) {
+        for (std::size_t i{}; i < count; ++i) {
+          CreateComponent<EntSig_t>(make_cmp(i));
+        }
+      } };
+      (fill_column([&](std::size_t i) -> decltype(auto) { return std::ranges::begin(rngs)[i]; }), ...);
+      Seq::ForEach_t<Seq::Difference_t<Cmps_t, ArgsTypes_t>>::Do(
+        [&]<class Cmp_t>() { fill_column([](std::size_t) { return Cmp_t{}; }); });
+    });
+  }
+
+  // makes room for count more entities of EntSig_t
+  template<class EntSig_t> constexpr auto Reserve(std::size_t count) -> void
+  {
+    Seq::ForEach_t<Traits::StoredComponents_t<EntSig_t>>::Do(
+      [&]<class Cmp_t>() { mComponentMan.template Reserve<EntSig_t, Cmp_t>(count); });
+    if constexpr (IsArchetype_v) {
+      mComponentMan.template Reserve<EntSig_t, Handle_t<EntSig_t>>(count);
+    }
+    mEntityMan.template Reserve<EntSig_t>(count);
   }
 
   template<class EntSig_t> constexpr auto Destroy(Handle_t<EntSig_t> e) -> void
   {
-    std::visit(
-      [&]<class T>(T eid) {
-        DestroyComponents(Traits::Components_t<typename T::type>{}, mEntityMan.GetEntity(eid));
-        mEntityMan.Destroy(eid);
-      },
-      mEntityMan.GetEntity(e).GetParentID());
+    TraceScope_t trace{ "Destroy", TypeName_v<EntSig_t>, 1 };
+    VisitParent<EntSig_t>(e, *this, [&]<class T>(T eid) {
+      Notify(eid, Lifecycle_t::Destroyed);
+      ClearTags(eid);
+      DestroyRow<typename T::type>(mEntityMan.GetEntity(eid));
+      mEntityMan.Destroy(eid);
+    });
+  }
+
+  // The rows of every entity are flagged first, then each container touched is
+  // compacted in a single pass. Repeated handles are destroyed once.
+  template<class EntSig_t>
+  constexpr auto Destroy(std::span<const Handle_t<EntSig_t>> es, Compaction_t compaction = Compaction_t::Unstable)
+    -> void
+  {
+    TraceScope_t trace{ "Destroy", TypeName_v<EntSig_t>, es.size() };
+    RowMarks_t   marks{};
+    for (auto e : es) {
+      VisitParent<EntSig_t>(e, *this, [&]<class T>(T eid) {
+        if (!IsMarked(marks, eid)) {
+          Notify(eid, Lifecycle_t::Destroyed);
+          ClearTags(eid);
+          MarkEntity(marks, eid);
+        }
+      });
+    }
+    EraseMarked(marks, compaction);
+  }
+
+  // pred takes the same arguments as a const ForEach callback and returns
+  // whether the entity has to be destroyed, testing it records no change
+  template<class EntSig_t>
+  constexpr auto DestroyIf(auto pred, Compaction_t compaction = Compaction_t::Unstable) -> std::size_t
+  {
+    std::vector<Handle_t<EntSig_t>> victims{};
+    std::as_const(*this).template ForEach<EntSig_t>([&](Handle_t<EntSig_t> e) {
+      if (ProcessEntity<EntSig_t>(e, pred, std::as_const(*this))) {
+        victims.emplace_back(e);
+      }
+    });
+    Destroy<EntSig_t>(victims, compaction);
+
+    return victims.size();
   }
 
   template<class DestSig_t, class EntSig_t, class... Args_t>
   constexpr auto TransformTo(Handle_t<EntSig_t> e, Args_t&&... args) -> Handle_t<DestSig_t>
   {
     using SrcSig_t   = EntSig_t;
-    using DestCmps_t = Traits::Components_t<DestSig_t>;
-    using SrcCmps_t  = Traits::Components_t<SrcSig_t>;
+    using DestCmps_t = Traits::StoredComponents_t<DestSig_t>;
+    using SrcCmps_t  = Traits::StoredComponents_t<SrcSig_t>;
     using RmCmps_t   = Seq::Difference_t<SrcCmps_t, DestCmps_t>;
     using MkCmps_t   = Seq::Difference_t<DestCmps_t, SrcCmps_t>;
 
@@ -177,12 +1184,26 @@ public:
     static_assert(Seq::IsSet_v<ArgsTypes>, "Component arguments must be unique.");
     static_assert(Seq::IsSubsetOf_v<ArgsTypes, MkCmps_t>,
                   "Components arguments does not match the requiered components");
-    const auto& ent{ mEntityMan.GetEntity(e) };
-    auto        old_ids{ ent.GetComponentIDs() };
-    auto        new_ids{ CreateComponents(RemainingComponents_t{}, std::forward<Args_t>(args)...) };
-    auto        ids{ std::tuple_cat(new_ids, old_ids) };
-    DestroyComponents(RmCmps_t{}, ent);
-    return { mEntityMan.template TransformTo<DestSig_t>(e, ids) };
+    TraceScope_t trace{ "TransformTo", TypeName_v<DestSig_t>, 1 };
+    auto         row{ GetRow(e) };
+    const auto&  ent{ mEntityMan.GetEntity(row) };
+    NotifyTransform<SrcSig_t, DestSig_t>(row, Lifecycle_t::TransformedOut);
+    auto new_ids{ CreateComponents<DestSig_t>(RemainingComponents_t{}, std::forward<Args_t>(args)...) };
+    Handle_t<DestSig_t> id{};
+    if constexpr (IsArchetype_v) {
+      using KeptCmps_t = Seq::Difference_t<DestCmps_t, MkCmps_t>;
+      auto ids{ std::tuple_cat(new_ids, MoveComponents<DestSig_t, SrcSig_t>(KeptCmps_t{}, ent)) };
+      DestroyRow<SrcSig_t>(ent);
+      id = mEntityMan.template TransformTo<DestSig_t>(row, ids);
+      CreateOwner(id);
+    } else {
+      auto ids{ std::tuple_cat(new_ids, ent.GetComponentIDs()) };
+      DestroyComponents<SrcSig_t>(RmCmps_t{}, ent);
+      id = mEntityMan.template TransformTo<DestSig_t>(row, ids);
+    }
+    MoveTags(row, id);
+    NotifyTransform<DestSig_t, SrcSig_t>(id, Lifecycle_t::TransformedIn);
+    return MakeHandle<DestSig_t>(id, *this);
   }
 
   // template<class BaseSig_t, class EntID_t, class... Args_t> constexpr auto
@@ -202,37 +1223,50 @@ public:
   //     from ent.");
   // }
 
+  // with virtual bases every view of an entity shares its handle value
   template<class Base_t, class EntSig_t> constexpr auto GetBaseID(Handle_t<EntSig_t> e) const -> Handle_t<Base_t>
   {
-    return mEntityMan.GetEntity(e).template GetBaseID<Base_t>();
+    if constexpr (IsVirtualBases_v) {
+      static_assert(Seq::Contains_v<Base_t, Traits::Bases_t<EntSig_t>>, "Not a base of this entity");
+      return { e.GetIndex() };
+    } else {
+      return mEntityMan.GetEntity(e).template GetBaseID<Base_t>();
+    }
   }
 
   template<class Cmpt_t, class EntSig_t> constexpr auto GetComponent(Handle_t<EntSig_t> e) const -> const Cmpt_t&
   {
-    static_assert(Seq::Contains_v<Cmpt_t, Traits::Components_t<EntSig_t>>, "This entity doesn't have this component");
-    auto& ent{ mEntityMan.GetEntity(e) };
-    return mComponentMan.GetComponent(ent.template GetComponentID<Cmpt_t>());
+    return FindComponent<Cmpt_t>(e, *this);
   }
 
-  template<class Cmpt_t, class EntSig_t> constexpr auto GetComponent(Handle_t<EntSig_t> ent_handle) -> Cmpt_t&
+  // the mutable accesses are recorded as changes of the component
+  template<class Cmpt_t, class EntSig_t> constexpr auto GetComponent(Handle_t<EntSig_t> e) -> Cmpt_t&
   {
-    return SameAsConstMemFunc(*this, &ECSManager_t::GetComponent<Cmpt_t, EntSig_t>, ent_handle);
+    return FindComponent<Cmpt_t>(e, *this);
   }
 
   template<class Cmp_t> constexpr auto GetComponent(Handle_t<Cmp_t> cmp_handle) const -> const Cmp_t&
   {
-    return mComponentMan.GetComponent(cmp_handle);
+    static_assert(!IsArchetype_v, "Component handles are per signature with archetype storage, use the entity handle.");
+    return mComponentMan.template GetComponent<void>(cmp_handle);
   }
 
   template<class Cmp_t> constexpr auto GetComponent(Handle_t<Cmp_t> cmp_handle) -> Cmp_t&
   {
-    return SameAsConstMemFunc(*this, &ECSManager_t::GetComponent<Cmp_t>, cmp_handle);
+    static_assert(!IsArchetype_v, "Component handles are per signature with archetype storage, use the entity handle.");
+    return mComponentMan.template GetComponent<void>(cmp_handle);
   }
 
   template<class Cmpt_t, class EntSig_t> constexpr auto GetComponentID(Handle_t<EntSig_t> e) const -> auto
   {
     static_assert(Seq::Contains_v<Cmpt_t, Traits::Components_t<EntSig_t>>, "This entity doesn't have this component");
-    return mEntityMan.GetEntity(e).template GetComponentID<Cmpt_t>();
+    static_assert(!Traits::IsTag_v<Cmpt_t>, "Tags have no handle");
+    if constexpr (IsVirtualBases_v) {
+      return VisitParent<EntSig_t>(
+        e, *this, [&](auto row) { return mEntityMan.GetEntity(row).template GetComponentID<Cmpt_t>(); });
+    } else {
+      return mEntityMan.GetEntity(e).template GetComponentID<Cmpt_t>();
+    }
   }
 
   template<class... Cmps_t> constexpr auto GetComponents(auto ent_id) const -> std::tuple<const Cmps_t&...>
@@ -269,14 +1303,148 @@ public:
     TraverseEntities<EntSig_t>(std::execution::seq, cb, *this);
   }
 
+  // Visits every entity whose signature has all the components Cmps_t, once
+  // from its concrete signature, e.g.
+  // `ForEachWith<Position_t, Velocity_t, Without_t<Frozen_t>>(cb)`
+  // The signatures are chosen at compile time, a Without_t<Ts...> among
+  // Cmps_t leaves out those with any of Ts, and the entities carrying any of
+  // Ts listed in Config_t::OptionalTags_t. cb receives the components in the
+  // order given, without the filters, and may take the handle of the entity
+  // last, then it must accept the handle of every signature matched.
+  template<class... Cmps_t> constexpr auto ForEachWith(auto cb) const -> void
+  {
+    using Query_t   = Traits::Query<EntitySignatures_t, Cmps_t...>;
+    using Filters_t = OptionalFilters_t<Cmps_t...>;
+    TraverseWith<typename Query_t::Required_t, Filters_t>(typename Query_t::Signatures_t{}, cb, *this);
+  }
+
+  template<class... Cmps_t> constexpr auto ForEachWith(auto cb) -> void
+  {
+    using Query_t   = Traits::Query<EntitySignatures_t, Cmps_t...>;
+    using Filters_t = OptionalFilters_t<Cmps_t...>;
+    TraverseWith<typename Query_t::Required_t, Filters_t>(typename Query_t::Signatures_t{}, cb, *this);
+  }
+
+  // runs on JobSystem_t::Default()
   template<class EntSig_t> constexpr auto ParallelForEach(auto cb) -> void
   {
-    TraverseEntities<EntSig_t>(std::execution::par_unseq, cb, *this);
+    TraverseEntities<EntSig_t>(JobSystem_t::Default(), cb, *this);
   }
 
   template<class EntSig_t> constexpr auto ParallelForEach(auto cb) const -> void
   {
-    TraverseEntities<EntSig_t>(std::execution::par_unseq, cb, *this);
+    TraverseEntities<EntSig_t>(JobSystem_t::Default(), cb, *this);
+  }
+
+  template<class EntSig_t> constexpr auto ParallelForEach(JobSystem_t& jobs, auto cb) -> void
+  {
+    TraverseEntities<EntSig_t>(jobs, cb, *this);
+  }
+
+  template<class EntSig_t> constexpr auto ParallelForEach(JobSystem_t& jobs, auto cb) const -> void
+  {
+    TraverseEntities<EntSig_t>(jobs, cb, *this);
+  }
+
+  // std::execution path, with libstdc++ the parallel policies require TBB
+  template<class EntSig_t, class Policy_t>
+    requires std::is_execution_policy_v<std::remove_cvref_t<Policy_t>>
+  constexpr auto ParallelForEach(Policy_t&& policy, auto cb) -> void
+  {
+    TraverseEntities<EntSig_t>(policy, cb, *this);
+  }
+
+  template<class EntSig_t, class Policy_t>
+    requires std::is_execution_policy_v<std::remove_cvref_t<Policy_t>>
+  constexpr auto ParallelForEach(Policy_t&& policy, auto cb) const -> void
+  {
+    TraverseEntities<EntSig_t>(policy, cb, *this);
+  }
+
+  // cb receives one std::span per component of EntSig_t, in the order of a
+  // ForEach callback without the tags, for every run of entities with
+  // contiguous components.
+  // Structural changes must be deferred with a CommandBuffer_t.
+  template<class EntSig_t> constexpr auto ForEachChunk(auto cb) const -> void
+  {
+    TraverseChunks<EntSig_t>(Traits::StoredComponents_t<EntSig_t>{}, cb, *this);
+  }
+
+  template<class EntSig_t> constexpr auto ForEachChunk(auto cb) -> void
+  {
+    TraverseChunks<EntSig_t>(Traits::StoredComponents_t<EntSig_t>{}, cb, *this);
+  }
+
+  // Like ForEach but only visits the entities whose Cmp_t changed after the
+  // version since. A component of a tracked type changes when it is created
+  // or accessed through a non-const GetComponent, ForEach or ForEachChunk, so
+  // systems that only read should go through a const ECSManager_t.
+  template<class EntSig_t, class Cmp_t> constexpr auto ForEachChanged(Version_t since, auto cb) const -> void
+  {
+    TraverseChanged<EntSig_t, Cmp_t>(instances_type<EntSig_t>{}, since, cb, *this);
+  }
+
+  template<class EntSig_t, class Cmp_t> constexpr auto ForEachChanged(Version_t since, auto cb) -> void
+  {
+    TraverseChanged<EntSig_t, Cmp_t>(instances_type<EntSig_t>{}, since, cb, *this);
+  }
+
+  // version given to the changes made from now on
+  constexpr auto Version() const -> Version_t { return mVersion; }
+
+  // Starts a new version and returns the previous one, e.g.
+  // `ForEachChanged<Sig, Cmp>(last_sync, sync); last_sync = Tick();`
+  constexpr auto Tick() -> Version_t
+  {
+    ++mVersion;
+    Seq::ForEach_t<ColumnTypes_t>::Do(
+      [&]<class Col_t>() { mComponentMan.template SetVersion<Col_t>(mVersion); });
+    return mVersion - 1;
+  }
+
+  // Restores the locality lost to the holes filled by erase with shared
+  // storage: the components of the entities of EntSig_t are permuted to
+  // follow the row order, at most budget rows per call so it can be spread
+  // over frames. Each signature gets its own range of a shared map, after the
+  // entities of the signatures listed before it holding the component, so
+  // defragmenting one signature leaves the others in order. The ranges move
+  // when entities are created or destroyed. Archetype columns are always in
+  // row order. Returns the number of components moved.
+  template<class EntSig_t>
+  constexpr auto Defragment(std::size_t budget = std::numeric_limits<std::size_t>::max()) -> std::size_t
+  {
+    if constexpr (IsArchetype_v) {
+      return 0;
+    } else {
+      return DefragmentRows<EntSig_t>(Traits::StoredComponents_t<EntSig_t>{}, budget);
+    }
+  }
+
+  // Fraction of the consecutive entity rows of EntSig_t whose components are
+  // not adjacent, 0 when ForEachChunk sees a single run and 1 when each entity
+  // is a chunk of its own.
+  template<class EntSig_t> constexpr auto Disorder() const -> double
+  {
+    return SampleDisorder<EntSig_t>(std::numeric_limits<std::size_t>::max());
+  }
+
+  using stats_type = WorldStats_t<Seq::Size_v<ColumnTypes_t>, Seq::Size_v<EntitySignatures_t>>;
+
+  // Sizes and memory of every container, each read in constant time. The
+  // disorder of each signature is estimated from at most samples rows spread
+  // over them, 0 skips it.
+  constexpr auto Stats(std::size_t samples = 64) const -> stats_type
+  {
+    stats_type stats{};
+    Seq::ForEach_t<ColumnTypes_t>::Do([&]<class Col_t>() {
+      stats.mComponents[Seq::IndexOf_v<Col_t, ColumnTypes_t>] = mComponentMan.template GetStats<Col_t>();
+    });
+    Seq::ForEach_t<EntitySignatures_t>::Do([&]<class Sign_t>() {
+      stats.mSignatures[Seq::IndexOf_v<Sign_t, EntitySignatures_t>] = {
+        TypeName<Sign_t>(), Size<Sign_t>(), mEntityMan.template GetStats<Sign_t>(), SampleDisorder<Sign_t>(samples)
+      };
+    });
+    return stats;
   }
 
   template<class SysSig_t, class EntSig_t> constexpr auto Match(Handle_t<EntSig_t> ent_handle, auto cb) const -> void
@@ -299,19 +1467,123 @@ public:
     MatchEntity(*this, ent_handle, cbs...);
   }
 
+  // Optional tags are the types listed in Config_t::OptionalTags_t, set and
+  // cleared per entity at runtime. Each one costs a bit per entity of every
+  // signature, the handle of any row of the entity can be used.
+  template<class Tag_t, class EntSig_t> constexpr auto AddTag(Handle_t<EntSig_t> e) -> void
+  {
+    VisitParent<EntSig_t>(
+      e, *this, [&]<class T>(T eid) { GetTagBits<typename T::type, Tag_t>().set(eid.GetIndex()); });
+  }
+
+  template<class Tag_t, class EntSig_t> constexpr auto RemoveTag(Handle_t<EntSig_t> e) -> void
+  {
+    VisitParent<EntSig_t>(
+      e, *this, [&]<class T>(T eid) { GetTagBits<typename T::type, Tag_t>().reset(eid.GetIndex()); });
+  }
+
+  template<class Tag_t, class EntSig_t> constexpr auto HasTag(Handle_t<EntSig_t> e) const -> bool
+  {
+    return VisitParent<EntSig_t>(
+      e, *this, [&]<class T>(T eid) { return GetTagBits<typename T::type, Tag_t>().test(eid.GetIndex()); });
+  }
+
+  // ForEach restricted to the entities with the optional tag Tag_t
+  template<class EntSig_t, class Tag_t> constexpr auto ForEachTagged(auto cb) const -> void
+  {
+    TraverseTagged<EntSig_t, Tag_t>(instances_type<EntSig_t>{}, cb, *this);
+  }
+
+  template<class EntSig_t, class Tag_t> constexpr auto ForEachTagged(auto cb) -> void
+  {
+    TraverseTagged<EntSig_t, Tag_t>(instances_type<EntSig_t>{}, cb, *this);
+  }
+
+  // Writes the whole world: the component columns and the entity rows with
+  // their free lists, so every handle stays valid, the optional tags and the
+  // versions. Blob columns are copied as a whole, see IsSnapshotBlob_v.
+  constexpr auto Save(SnapshotWriter_t& out) const -> void
+  {
+    out.Write(snapshot_magic);
+    out.Write(snapshot_version);
+    out.Write(SnapshotFingerprint());
+    Seq::ForEach_t<ColumnTypes_t>::Do([&]<class Col_t>() { mComponentMan.template Save<Col_t>(out); });
+    Seq::ForEach_t<EntitySignatures_t>::Do([&]<class Sign_t>() { mEntityMan.template Save<Sign_t>(out); });
+    for (const auto& bits : mTagBits) {
+      bits.save(out);
+    }
+    for (auto cursor : mDefragCursors) {
+      out.Write(static_cast<std::uint64_t>(cursor.mRow));
+      out.Write(static_cast<std::uint64_t>(cursor.mRank));
+    }
+    out.Write(mVersion);
+  }
+
+  // Replaces the world with a snapshot saved by a manager with the same
+  // Config_t. Returns false, leaving the world empty, when the bytes are
+  // truncated, have another layout or the bookkeeping of a map does not hold.
+  // The pending lifecycle events are dropped.
+  constexpr auto Load(SnapshotReader_t& in) -> bool { return LoadWorld(in); }
+
+  // Same as Load but the columns and rows stay in the image, which must
+  // outlive the world, see WorldImage_t. Only the header and the tag bits are
+  // read, each map copies its arrays to storage of its own once it grows.
+  // The image is trusted beyond its header and sizes.
+  constexpr auto Map(ImageReader_t& in) -> bool { return LoadWorld(in); }
+
+  // Starts recording the lifecycle events of the entities of EntSig_t, those
+  // of its instances included, in a queue holding up to capacity events
+  // between two drains, the ones past it are dropped and counted.
+  // Recording costs a branch per signature touched until it is observed.
+  template<class EntSig_t> constexpr auto Observe(std::size_t capacity) -> void
+  {
+    GetEventQueue<EntSig_t>().Observe(capacity);
+  }
+
+  // stops recording and drops the pending events
+  template<class EntSig_t> constexpr auto Unobserve() -> void
+  {
+    GetEventQueue<EntSig_t>().Unobserve();
+  }
+
+  // Calls cb once with a std::span of the LifecycleEvent_t recorded for
+  // EntSig_t since the last drain, if any, and returns their number. cb may
+  // take the number of events dropped by a full queue as a second argument.
+  // The world can be changed from cb, the events it records are kept for the
+  // next drain.
+  template<class EntSig_t> constexpr auto DrainEvents(auto cb) -> std::size_t
+  {
+    return GetEventQueue<EntSig_t>().Drain(cb);
+  }
+
+  // events of EntSig_t dropped since the last drain because its queue was full
+  template<class EntSig_t> constexpr auto DroppedEvents() const -> std::size_t
+  {
+    return GetEventQueue<EntSig_t>().Dropped();
+  }
+
+  // number of entities of Sign_t, those of its instances included
   template<class Sign_t> constexpr auto Size() const -> std::size_t
   {
-    return mEntityMan.template size<entity_type<Sign_t>>();
+    return Seq::Unpacker_t<RowSignatures_t<Sign_t>>::Call(
+      [&]<class... Signs_t>() { return (mEntityMan.template size<entity_type<Signs_t>>() + ...); });
   }
 
+  // number of entity rows
   constexpr auto SizeAll() const -> std::uintmax_t
   {
-    return Seq::Unpacker_t<EntitySignatures_t>::Call([&]<class... Signs_t>() { return (Size<Signs_t>() + ...); });
+    return Seq::Unpacker_t<EntitySignatures_t>::Call(
+      [&]<class... Signs_t>() { return (mEntityMan.template size<entity_type<Signs_t>>() + ...); });
   }
 
 private:
   ComponentMan_t mComponentMan{};
   EntityMan_t    mEntityMan{};
+  EventQueues_t  mEvents;
+  TagBits_t      mTagBits;
+
+  std::array<DefragCursor_t, Seq::Size_v<EntitySignatures_t>> mDefragCursors{};
+  Version_t                                                   mVersion{ 1 };
 };
 
 } // namespace ECS
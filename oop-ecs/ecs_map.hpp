@@ -1,153 +1,538 @@
 #pragma once
 
+#include "image_vector.hpp"
+#include "paged_vector.hpp"
+#include "snapshot.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <iterator>
-#include <vector>
+#include <limits>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
 
 namespace ECS {
 
-template<class T> struct ECSMap_t
+// Storage used for the values of an ECSMap_t. A component selects it with a
+// nested `using values_type = ECS::PagedValues_t<16 * 1024>;` or by
+// specializing ValuesOf. Contiguous values can be borrowed from a world image.
+struct ContiguousValues_t
 {
-  struct Slot_t;
+  template<class T, class Alloc_t> using container_type = ImageVector_t<T, Alloc_t>;
+};
 
-  using value_type      = typename std::vector<Slot_t>::value_type;
-  using size_type       = typename std::vector<Slot_t>::size_type;
-  using difference_type = typename std::vector<Slot_t>::difference_type;
-  using reference       = typename std::vector<Slot_t>::reference;
-  using const_reference = typename std::vector<Slot_t>::const_reference;
-  using pointer         = typename std::vector<Slot_t>::pointer;
-  using const_pointer   = typename std::vector<Slot_t>::const_pointer;
+template<std::size_t PageBytes> struct PagedValues_t
+{
+  template<class T, class Alloc_t> using container_type = PagedVector_t<T, PageBytes, Alloc_t>;
+};
 
-  using iterator               = typename std::vector<Slot_t>::iterator;
-  using const_iterator         = typename std::vector<Slot_t>::const_iterator;
-  using reverse_iterator       = typename std::vector<Slot_t>::reverse_iterator;
-  using const_reverse_iterator = typename std::vector<Slot_t>::const_reverse_iterator;
+template<class T, class = void> struct ValuesOf : std::type_identity<ContiguousValues_t>
+{};
 
-  struct Key_t
-  {
-    using value_type = T;
+template<class T> struct ValuesOf<T, std::void_t<typename T::values_type>> : std::type_identity<typename T::values_type>
+{};
 
-    friend ECSMap_t;
+template<class T, class Alloc_t>
+using ValuesContainer_t = typename ValuesOf<T>::type::template container_type<T, Alloc_t>;
 
-    constexpr Key_t() = default;
-    constexpr Key_t(size_type index)
-      : mIndex{ index } {};
+// A component opts in the tracking of its changes with a nested
+// `static constexpr bool track_changes{ true };` or by specializing
+// TracksChanges.
+template<class T, class = void> struct TracksChanges : std::false_type
+{};
 
-    constexpr auto GetIndex() const -> size_type { return mIndex; }
+template<class T>
+struct TracksChanges<T, std::void_t<decltype(T::track_changes)>> : std::bool_constant<T::track_changes>
+{};
 
-    constexpr operator size_type() { return mIndex; }
+template<class T> constexpr bool TracksChanges_v{ TracksChanges<T>::value };
 
-  private:
-    size_type mIndex{};
-  };
+// Values a map of T can hold: what Index_t addresses, or less when T sets a
+// nested `static constexpr std::size_t max_keys`.
+template<class T, class Index_t, class = void>
+struct MaxKeys : std::integral_constant<std::size_t, std::numeric_limits<Index_t>::max()>
+{};
 
-  struct Slot_t
-  {
-    using value_type = T;
-    friend ECSMap_t;
+template<class T, class Index_t>
+struct MaxKeys<T, Index_t, std::void_t<decltype(T::max_keys)>> : std::integral_constant<std::size_t, T::max_keys>
+{};
 
-  private:
-    T         mValue{};
-    size_type mEraseIndex{};
-    size_type mIndex{};
+template<class T, class Index_t> constexpr std::size_t MaxKeys_v{ MaxKeys<T, Index_t>::value };
 
-  public:
-    template<class... Args_t>
-    constexpr explicit Slot_t(Args_t&&... args)
-      : mValue{ std::forward<Args_t>(args)... }
-    {
-    }
+using Version_t = std::uint32_t;
 
-    constexpr auto value() -> T& { return mValue; }
+// How the gaps left by a bulk erase are closed. Stable keeps the order of the
+// remaining values, Unstable fills each gap with the last value as erase does.
+enum class Compaction_t : bool
+{
+  Unstable,
+  Stable
+};
+
+// Sparse set: the values are tightly packed in mValues, mKeys maps each
+// position back to its key and mIndices maps each key to its position. The
+// unused entries of mIndices form the free list of keys.
+// Keys do not depend on the allocator so the same handles work with every
+// ECSMap_t of T.
+// When T tracks its changes every position also holds the version of its
+// last mutable access, and every version_chunk_size positions the newest of
+// their versions, so unchanged ranges can be skipped.
+// Keys and positions are stored as Index_t, a narrow type halves the memory
+// of the bookkeeping but limits the map to max_keys values, max() of Index_t
+// unless T lowers it, which is only checked in debug builds and when a
+// snapshot is loaded.
+template<class T, class Index_t = std::size_t> struct MapKey_t
+{
+  using value_type = T;
+  using index_type = Index_t;
 
-    constexpr auto value() const -> const T& { return mValue; }
+  constexpr MapKey_t() = default;
+  constexpr MapKey_t(index_type index)
+    : mIndex{ index } {};
 
-    constexpr auto key() const -> ECSMap_t::Key_t { return { mEraseIndex }; }
-  };
+  constexpr auto GetIndex() const -> index_type { return mIndex; }
+
+  constexpr operator index_type() { return mIndex; }
+
+private:
+  index_type mIndex{};
+};
 
-  constexpr explicit ECSMap_t() = default;
+template<class T, class Alloc_t = std::allocator<T>, class Index_t = std::size_t> struct ECSMap_t
+{
+  static_assert(std::is_unsigned_v<Index_t>, "The index type must be an unsigned integer");
+
+  template<class U> using rebind_alloc = typename std::allocator_traits<Alloc_t>::template rebind_alloc<U>;
+
+  using allocator_type  = Alloc_t;
+  using container_type  = ValuesContainer_t<T, rebind_alloc<T>>;
+  using value_type      = typename container_type::value_type;
+  using size_type       = typename container_type::size_type;
+  using difference_type = typename container_type::difference_type;
+  using reference       = typename container_type::reference;
+  using const_reference = typename container_type::const_reference;
+  using pointer         = typename container_type::pointer;
+  using const_pointer   = typename container_type::const_pointer;
+
+  using iterator               = typename container_type::iterator;
+  using const_iterator         = typename container_type::const_iterator;
+  using reverse_iterator       = typename container_type::reverse_iterator;
+  using const_reverse_iterator = typename container_type::const_reverse_iterator;
+
+  using index_type = Index_t;
+  using Key_t      = MapKey_t<T, index_type>;
+
+  static constexpr bool      tracks_changes{ TracksChanges_v<T> };
+  static constexpr size_type version_chunk_size{ 64 };
+  static constexpr size_type max_keys{ MaxKeys_v<T, Index_t> };
+
+  constexpr explicit ECSMap_t(const Alloc_t& alloc = Alloc_t{})
+    : mValues{ rebind_alloc<T>{ alloc } }
+    , mKeys{ rebind_alloc<index_type>{ alloc } }
+    , mIndices{ rebind_alloc<index_type>{ alloc } }
+    , mVersions{ rebind_alloc<Version_t>{ alloc } }
+    , mChunkVersions{ rebind_alloc<Version_t>{ alloc } }
+  {
+  }
 
-  constexpr auto push_back(const T& value) -> void { emplace_back(std::move(value)); }
+  constexpr auto push_back(const T& value) -> void { emplace_back(value); }
 
-  template<class... Args_t> [[nodiscard]] constexpr auto emplace_back(Args_t&&... args) -> reference
+  template<class... Args_t> constexpr auto emplace_back(Args_t&&... args) -> reference
   {
-    if (mFreeIndex == mLastIndex && mLastIndex == mData.size()) {
-      auto& slot{ mData.emplace_back(std::forward<Args_t>(args)...) };
-      slot.mIndex = slot.mEraseIndex = mFreeIndex;
+    assert(mValues.size() < max_keys && "ECSMap_t holds max_keys values");
+    auto key{ mFreeIndex };
+    auto pos{ static_cast<index_type>(mValues.size()) };
+    if (key == mIndices.size()) {
+      mIndices.emplace_back(pos);
       ++mFreeIndex;
     } else {
-      new (&mData[mLastIndex].mValue) T{ std::forward<Args_t>(args)... };
-      mData[mLastIndex].mEraseIndex = mFreeIndex;
-      auto next_free_index{ mData[mFreeIndex].mIndex };
-      mData[mFreeIndex].mIndex = mLastIndex;
-      mFreeIndex               = next_free_index;
+      mFreeIndex    = mIndices[key];
+      mIndices[key] = pos;
     }
-    return mData[mLastIndex++];
+    mKeys.emplace_back(key);
+    auto& value{ mValues.emplace_back(std::forward<Args_t>(args)...) };
+    if constexpr (tracks_changes) {
+      mVersions.emplace_back();
+      if (mChunkVersions.size() * version_chunk_size < mVersions.size()) {
+        mChunkVersions.emplace_back();
+      }
+      Stamp(mVersions.size() - 1, mVersion);
+    }
+    return value;
   }
 
   constexpr auto erase(ECSMap_t::Key_t key) -> void
   {
-    --mLastIndex;
-    if (mData[key.mIndex].mIndex != mLastIndex) {
-      mData[mData[key.mIndex].mIndex].mValue = std::move(mData[mLastIndex].mValue);
+    auto pos{ mIndices[key.GetIndex()] };
+    auto last{ mValues.size() - 1 };
+    if (pos != last) {
+      MoveValue(last, pos);
+    }
+    mValues.pop_back();
+    mKeys.pop_back();
+    if constexpr (tracks_changes) {
+      mVersions.pop_back();
+    }
+    FreeKey(key.GetIndex());
+  }
+
+  // erases in a single pass the values whose position is set in marks
+  template<class Marks_t> constexpr auto erase_marked(const Marks_t& marks, Compaction_t compaction) -> void
+  {
+    size_type last{};
+    if (compaction == Compaction_t::Stable) {
+      for (size_type pos{}; pos < mValues.size(); ++pos) {
+        if (marks[pos]) {
+          FreeKey(mKeys[pos]);
+        } else {
+          if (pos != last) {
+            MoveValue(pos, last);
+          }
+          ++last;
+        }
+      }
+    } else {
+      last = mValues.size();
+      for (size_type pos{}; pos < last; ++pos) {
+        if (marks[pos]) {
+          FreeKey(mKeys[pos]);
+          while (--last > pos && marks[last]) {
+            FreeKey(mKeys[last]);
+          }
+          if (last > pos) {
+            MoveValue(last, pos);
+          }
+        }
+      }
+    }
+    while (mValues.size() > last) {
+      mValues.pop_back();
+    }
+    mKeys.resize(last);
+    if constexpr (tracks_changes) {
+      mVersions.resize(last);
     }
-    mData[mData[key.mIndex].mIndex].mEraseIndex = mData[mLastIndex].mEraseIndex;
-    // update the key
-    mData[mData[mLastIndex].mEraseIndex].mIndex = mData[key.mIndex].mIndex;
-    // update the index list
-    mData[key.mIndex].mIndex = mFreeIndex;
-    mFreeIndex               = key.mIndex;
   }
 
   constexpr auto clear() -> void
   {
-    mFreeIndex = mLastIndex = 0;
-    mData.clear();
+    mFreeIndex = 0;
+    mValues.clear();
+    mKeys.clear();
+    mIndices.clear();
+    mVersions.clear();
+    mChunkVersions.clear();
   }
 
-  constexpr auto size() const -> size_type { return mLastIndex; }
+  constexpr auto shrink_to_fit() -> void
+  {
+    mValues.shrink_to_fit();
+    mKeys.shrink_to_fit();
+    mIndices.shrink_to_fit();
+    mVersions.shrink_to_fit();
+    mChunkVersions.shrink_to_fit();
+  }
+
+  constexpr auto reserve(size_type new_cap) -> void
+  {
+    mValues.reserve(new_cap);
+    mKeys.reserve(new_cap);
+    mIndices.reserve(new_cap);
+    if constexpr (tracks_changes) {
+      mVersions.reserve(new_cap);
+    }
+  }
+
+  constexpr auto size() const -> size_type { return mValues.size(); }
+
+  [[nodiscard]] constexpr auto empty() const -> bool { return mValues.empty(); }
+
+  constexpr auto capacity() const -> size_type { return mValues.capacity(); }
+
+  // keys released by erase, the next insertions use them again
+  constexpr auto free_count() const -> size_type { return mIndices.size() - mKeys.size(); }
+
+  // bytes of the values and of the key, index and version entries they use
+  constexpr auto used_bytes() const -> size_type
+  {
+    auto bytes{ size() * (sizeof(T) + 2 * sizeof(index_type)) };
+    if constexpr (tracks_changes) {
+      bytes += (size() + (size() + version_chunk_size - 1) / version_chunk_size) * sizeof(Version_t);
+    }
+    return bytes;
+  }
+
+  // bytes held, with the spare capacity and the entries of the free keys
+  constexpr auto allocated_bytes() const -> size_type
+  {
+    return capacity() * sizeof(T) + (mKeys.capacity() + mIndices.capacity()) * sizeof(index_type) +
+           (mVersions.capacity() + mChunkVersions.capacity()) * sizeof(Version_t);
+  }
 
-  constexpr auto erase(const_iterator it) -> void { erase(it->key()); }
+  // only available with contiguous values
+  constexpr auto data() -> pointer { return mValues.data(); }
+
+  constexpr auto data() const -> const_pointer { return mValues.data(); }
+
+  // number of values stored contiguously starting at pos
+  constexpr auto contiguous_size(size_type pos) const -> size_type
+  {
+    if constexpr (requires { mValues.contiguous_size(pos); }) {
+      return mValues.contiguous_size(pos);
+    } else {
+      return mValues.size() - pos;
+    }
+  }
+
+  constexpr auto erase(const_iterator it) -> void { erase(get_key(static_cast<size_type>(it - cbegin()))); }
 
   constexpr auto next_key() const -> Key_t { return { mFreeIndex }; }
 
-  constexpr auto get_key(size_type pos) const -> Key_t { return { mData[pos].mEraseIndex }; }
+  constexpr auto back_key() const -> Key_t { return { mKeys.back() }; }
+
+  constexpr auto get_key(size_type pos) const -> Key_t { return { mKeys[pos] }; }
+
+  constexpr auto get_pos(ECSMap_t::Key_t key) const -> size_type { return mIndices[key.GetIndex()]; }
 
-  constexpr auto operator[](ECSMap_t::Key_t key) -> T& { return mData[mData[key.mIndex].mIndex].mValue; }
+  // exchanges the values at two positions, their keys follow them
+  constexpr auto swap_values(size_type pos1, size_type pos2) -> void
+  {
+    using std::swap;
+    swap(mValues[pos1], mValues[pos2]);
+    swap(mKeys[pos1], mKeys[pos2]);
+    mIndices[mKeys[pos1]] = static_cast<index_type>(pos1);
+    mIndices[mKeys[pos2]] = static_cast<index_type>(pos2);
+    if constexpr (tracks_changes) {
+      auto version1{ mVersions[pos1] };
+      Stamp(pos1, mVersions[pos2]);
+      Stamp(pos2, version1);
+    }
+  }
+
+  // the mutable accessors record a change of the value
+  constexpr auto get_value(size_type pos) -> T&
+  {
+    touch(pos);
+    return mValues[pos];
+  }
+
+  constexpr auto get_value(size_type pos) const -> const T& { return mValues[pos]; }
+
+  constexpr auto operator[](ECSMap_t::Key_t key) -> T& { return get_value(mIndices[key.GetIndex()]); }
+
+  constexpr auto operator[](ECSMap_t::Key_t key) const -> const T& { return mValues[mIndices[key.GetIndex()]]; }
+
+  // version given to the values changed from now on
+  constexpr auto set_version(Version_t version) -> void { mVersion = version; }
+
+  // records a change of the count values starting at pos
+  constexpr auto touch(size_type pos, size_type count = 1) -> void
+  {
+    if constexpr (tracks_changes) {
+      for (auto last{ pos + count }; pos < last; ++pos) {
+        Stamp(pos, mVersion);
+      }
+    }
+  }
 
-  constexpr auto operator[](ECSMap_t::Key_t key) const -> const T& { return mData[mData[key.mIndex].mIndex].mValue; }
+  // version of the last change of the value at pos, 0 when T is not tracked
+  constexpr auto get_version(size_type pos) const -> Version_t
+  {
+    if constexpr (tracks_changes) {
+      return mVersions[pos];
+    } else {
+      return 0;
+    }
+  }
+
+  // newest version in the chunk of version_chunk_size positions starting at
+  // chunk * version_chunk_size, it can be newer than the values left there
+  constexpr auto get_chunk_version(size_type chunk) const -> Version_t
+  {
+    if constexpr (tracks_changes) {
+      return mChunkVersions[chunk];
+    } else {
+      return 0;
+    }
+  }
+
+  // Writes the free list, the keys, the versions and the aligned values, those
+  // of a blob type in contiguous runs, the others through their SnapshotCodec.
+  constexpr auto save(SnapshotWriter_t& out) const -> void
+  {
+    static_assert(IsSnapshotBlob_v<T> || HasSnapshotCodec<T>, "The value type needs a SnapshotCodec");
+    out.Write(mFreeIndex);
+    out.Write(mVersion);
+    out.WriteArray(mKeys);
+    out.WriteArray(mIndices);
+    if constexpr (tracks_changes) {
+      out.WriteArray(mVersions);
+      out.WriteArray(mChunkVersions);
+    }
+    out.Align();
+    for (size_type pos{}, len{}; pos < size(); pos += len) {
+      len = contiguous_size(pos);
+      if constexpr (IsSnapshotBlob_v<T>) {
+        out.WriteBytes(std::addressof(mValues[pos]), len * sizeof(T));
+      } else {
+        for (auto i{ pos }; i < pos + len; ++i) {
+          SnapshotCodec<T>::Write(out, mValues[i]);
+        }
+      }
+    }
+  }
 
-  // constexpr auto operator[](size_type pos) -> T& { return mData[pos].mValue; }
+  // Replaces the content with the one written by save. The bookkeeping is
+  // checked, on failure the map is left empty.
+  constexpr auto load(SnapshotReader_t& in) -> bool { return Load(in); }
 
-  // constexpr auto operator[](size_type pos) const -> const T& { return mData[pos].mValue; }
+  // Same as load but the bookkeeping and the blob values of contiguous
+  // storage are used in place from the image, the first growth of each array
+  // copies it. The image is trusted, only the sizes are checked.
+  constexpr auto borrow(ImageReader_t& in) -> bool { return Load(in); }
 
-  constexpr auto begin() -> iterator { return mData.begin(); }
+  constexpr auto begin() -> iterator { return mValues.begin(); }
 
-  constexpr auto begin() const -> const_iterator { return mData.begin(); }
+  constexpr auto begin() const -> const_iterator { return mValues.begin(); }
 
-  constexpr auto cbegin() const -> const_iterator { return mData.cbegin(); }
+  constexpr auto cbegin() const -> const_iterator { return mValues.cbegin(); }
 
-  constexpr auto rbegin() -> reverse_iterator { return std::make_reverse_iterator(end()); }
+  constexpr auto rbegin() -> reverse_iterator { return mValues.rbegin(); }
 
-  constexpr auto rbegin() const -> const_reverse_iterator { return std::make_reverse_iterator(end()); }
+  constexpr auto rbegin() const -> const_reverse_iterator { return mValues.rbegin(); }
 
-  constexpr auto crbegin() const -> const_reverse_iterator { return std::make_reverse_iterator(end()); }
+  constexpr auto crbegin() const -> const_reverse_iterator { return mValues.crbegin(); }
 
-  constexpr auto end() -> iterator { return begin() + mLastIndex; }
+  constexpr auto end() -> iterator { return mValues.end(); }
 
-  constexpr auto end() const -> const_iterator { return begin() + mLastIndex; }
+  constexpr auto end() const -> const_iterator { return mValues.end(); }
 
-  constexpr auto cend() const -> const_iterator { return begin() + mLastIndex; }
+  constexpr auto cend() const -> const_iterator { return mValues.cend(); }
 
-  constexpr auto rend() -> reverse_iterator { return std::make_reverse_iterator(begin()); }
+  constexpr auto rend() -> reverse_iterator { return mValues.rend(); }
 
-  constexpr auto rend() const -> const_reverse_iterator { return std::make_reverse_iterator(begin()); }
+  constexpr auto rend() const -> const_reverse_iterator { return mValues.rend(); }
 
-  constexpr auto crend() const -> const_reverse_iterator { return std::make_reverse_iterator(begin()); }
+  constexpr auto crend() const -> const_reverse_iterator { return mValues.crend(); }
 
 private:
-  size_type           mFreeIndex{};
-  size_type           mLastIndex{};
-  std::vector<Slot_t> mData{};
+  constexpr auto MoveValue(size_type from, size_type to) -> void
+  {
+    mValues[to]         = std::move(mValues[from]);
+    mKeys[to]           = mKeys[from];
+    mIndices[mKeys[to]] = static_cast<index_type>(to);
+    if constexpr (tracks_changes) {
+      Stamp(to, mVersions[from]);
+    }
+  }
+
+  // The chunk version is written atomically since a parallel ForEach can
+  // change values of the same chunk from several threads.
+  constexpr auto Stamp(size_type pos, Version_t version) -> void
+  {
+    mVersions[pos] = version;
+    std::atomic_ref chunk{ mChunkVersions[pos / version_chunk_size] };
+    if (chunk.load(std::memory_order_relaxed) < version) {
+      chunk.store(version, std::memory_order_relaxed);
+    }
+  }
+
+  // every position is found back through its key and the free list goes
+  // through each unused key once
+  constexpr auto IsConsistent() const -> bool
+  {
+    if (mKeys.size() > mIndices.size() || mIndices.size() > max_keys) {
+      return false;
+    }
+    for (size_type pos{}; pos < mKeys.size(); ++pos) {
+      if (mKeys[pos] >= mIndices.size() || mIndices[mKeys[pos]] != pos) {
+        return false;
+      }
+    }
+    auto free{ mFreeIndex };
+    for (auto count{ mIndices.size() - mKeys.size() }; count-- > 0; free = mIndices[free]) {
+      if (free >= mIndices.size() || (mIndices[free] < mKeys.size() && mKeys[mIndices[free]] == free)) {
+        return false;
+      }
+    }
+    return free == mIndices.size();
+  }
+
+  template<class Reader_t> constexpr auto Load(Reader_t& in) -> bool
+  {
+    constexpr bool borrow{ std::is_same_v<Reader_t, ImageReader_t> };
+    constexpr bool borrow_values{ borrow && IsSnapshotBlob_v<T> &&
+                                  requires(container_type& values, std::span<T> image) { values.borrow(image); } };
+
+    auto read_array{ [&in]<class Array_t>(Array_t& array) {
+      if constexpr (borrow) {
+        array.borrow(in.template BorrowArray<typename Array_t::value_type>());
+      } else {
+        in.ReadArray(array);
+      }
+    } };
+
+    clear();
+    mFreeIndex = in.template Read<index_type>();
+    mVersion   = in.template Read<Version_t>();
+    read_array(mKeys);
+    read_array(mIndices);
+    if constexpr (tracks_changes) {
+      read_array(mVersions);
+      read_array(mChunkVersions);
+      if (mVersions.size() != mKeys.size() || mChunkVersions.size() * version_chunk_size < mVersions.size()) {
+        in.Fail();
+      }
+    }
+    if constexpr (borrow) {
+      if (mKeys.size() > mIndices.size() || mFreeIndex > mIndices.size()) {
+        in.Fail();
+      }
+    } else if (!in.Failed() && !IsConsistent()) {
+      in.Fail();
+    }
+    in.Align();
+    if (!in.Failed()) {
+      if constexpr (borrow_values) {
+        mValues.borrow(in.template Borrow<T>(mKeys.size()));
+      } else if constexpr (IsSnapshotBlob_v<T>) {
+        mValues.resize(mKeys.size());
+        for (size_type pos{}, len{}; pos < size(); pos += len) {
+          len = contiguous_size(pos);
+          in.ReadBytes(std::addressof(mValues[pos]), len * sizeof(T));
+        }
+      } else {
+        mValues.reserve(mKeys.size());
+        while (mValues.size() < mKeys.size() && !in.Failed()) {
+          mValues.emplace_back(SnapshotCodec<T>::Read(in));
+        }
+      }
+    }
+    if (in.Failed()) {
+      clear();
+    }
+    return !in.Failed();
+  }
+
+  // the free list is threaded through the unused entries of mIndices
+  constexpr auto FreeKey(index_type key) -> void
+  {
+    mIndices[key] = mFreeIndex;
+    mFreeIndex    = key;
+  }
+
+  index_type                                          mFreeIndex{};
+  container_type                                      mValues{};
+  ImageVector_t<index_type, rebind_alloc<index_type>> mKeys{};
+  ImageVector_t<index_type, rebind_alloc<index_type>> mIndices{};
+  ImageVector_t<Version_t, rebind_alloc<Version_t>>   mVersions{};
+  ImageVector_t<Version_t, rebind_alloc<Version_t>>   mChunkVersions{};
+  Version_t                                           mVersion{ 1 };
 };
 
 } // namespace ECS
@@ -1,80 +1,178 @@
 #pragma once
 
 #include "helpers.hpp"
+#include "snapshot.hpp"
 #include "type_aliases.hpp"
 
 #include <tmpl/sequence.hpp>
 
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <limits>
 #include <tuple>
+#include <type_traits>
 
 namespace ECS {
 
-template<class Config_t> struct Entity_t final : Uncopyable_t
+// Link to the concrete entity of a row packed in a single word: the index of
+// its signature in the signature list in the high bits and its key in the
+// rest, so the keys of a signature are limited to what is left.
+template<class Index_t, std::size_t Signatures> struct ParentID_t
 {
-public:
-  using Signature_t     = typename Config_t::Signature_t;
-  using Components_t    = typename Config_t::Components_t;
-  using Bases_t         = typename Config_t::Bases_t;
-  using ComponentIDs_t  = typename Config_t::ComponentIDs_t;
-  using BasesIDs_t      = typename Config_t::BasesIDs_t;
-  using ParentVariant_t = typename Config_t::ParentVariant_t;
+  using index_type = Index_t;
 
-  template<class T> using EntityID_t = ID_t<Entity_t<typename Config_t::template Self_t<T>>>;
+  static constexpr int signature_bits{ std::bit_width(Signatures - 1) };
+  static constexpr int row_bits{ std::numeric_limits<index_type>::digits - signature_bits };
+  static constexpr index_type row_mask{ std::numeric_limits<index_type>::max() >> signature_bits };
 
-  template<class ParentID_t = Handle_t<Signature_t>>
-  constexpr explicit Entity_t(auto cmp_ids, ParentID_t parent_id = {})
-    : Entity_t(Components_t{}, cmp_ids, parent_id)
+  static_assert(row_bits > 0, "The index type is too narrow for the number of signatures");
+
+  constexpr ParentID_t() = default;
+
+  constexpr ParentID_t(std::size_t signature, index_type row)
+    : mWord{ static_cast<index_type>(Pack(signature) | row) }
   {
+    assert((row & ~row_mask) == 0 && "ParentID_t row overflow");
   }
 
-  constexpr Entity_t(Entity_t&& other) noexcept
-    : mComponentIDs{ std::move(other.mComponentIDs) }
-    , mBases{ std::move(other.mBases) }
-    , mParent{ std::move(other.mParent) }
+  constexpr auto GetSignature() const -> std::size_t
+  {
+    if constexpr (signature_bits == 0) {
+      return 0;
+    } else {
+      return static_cast<std::size_t>(mWord >> row_bits);
+    }
+  }
+
+  constexpr auto GetRow() const -> index_type { return static_cast<index_type>(mWord & row_mask); }
+
+  constexpr auto GetWord() const -> index_type { return mWord; }
+
+  static constexpr auto FromWord(index_type word) -> ParentID_t
   {
+    ParentID_t parent{};
+    parent.mWord = word;
+    return parent;
   }
 
-  constexpr auto operator=(Entity_t&& other) noexcept -> Entity_t&
+private:
+  static constexpr auto Pack(std::size_t signature) -> index_type
   {
-    mComponentIDs = std::move(other.mComponentIDs);
-    mBases        = std::move(other.mBases);
-    mParent       = std::move(other.mParent);
+    if constexpr (signature_bits == 0) {
+      return 0;
+    } else {
+      return static_cast<index_type>(signature << row_bits);
+    }
+  }
+
+  index_type mWord{};
+};
+
+// parent link of the rows of a world without base rows, each is its own parent
+struct NoParentID_t
+{};
 
-    return *this;
+template<class Config_t> struct Entity_t final
+{
+public:
+  using Signature_t    = typename Config_t::Signature_t;
+  using Components_t   = typename Config_t::Components_t;
+  using Bases_t        = typename Config_t::Bases_t;
+  using ComponentIDs_t = typename Config_t::ComponentIDs_t;
+  using BasesIDs_t     = typename Config_t::BasesIDs_t;
+  using ParentID_t     = typename Config_t::ParentID_t;
+  using Signatures_t   = typename Config_t::Signatures_t;
+  using index_type     = typename Config_t::index_type;
+
+  template<class T> using Handle_t   = ECS::Handle_t<T, index_type>;
+  template<class T> using EntityID_t = ID_t<Entity_t<typename Config_t::template Self_t<T>>, index_type>;
+
+  // the rows of a signature are limited to the keys a parent link can hold
+  static constexpr std::size_t max_keys{ [] {
+    if constexpr (std::is_empty_v<ParentID_t>) {
+      return std::size_t{ std::numeric_limits<index_type>::max() };
+    } else {
+      return std::size_t{ ParentID_t::row_mask };
+    }
+  }() };
+
+  constexpr Entity_t() = default;
+
+  template<class Parent_t = Handle_t<Signature_t>>
+  constexpr explicit Entity_t(auto cmp_ids, Parent_t parent_id = {})
+    : Entity_t(Components_t{}, cmp_ids, parent_id)
+  {
   }
 
+  constexpr Entity_t(Entity_t&&)                    = default;
+  Entity_t(const Entity_t&)                         = delete;
+  constexpr auto operator=(Entity_t&&) -> Entity_t& = default;
+  auto operator=(const Entity_t&) -> Entity_t&      = delete;
+  ~Entity_t()                                       = default;
+
   template<class Cmpt_t> constexpr auto GetComponentID() const -> auto
   {
-    return std::get<Handle_t<Cmpt_t>>(mComponentIDs);
+    return Handle_t<Cmpt_t>{ mComponentIDs[TMPL::Sequence::IndexOf_v<Cmpt_t, Components_t>] };
   }
 
-  template<class EntSign_t> constexpr auto GetBaseID() const -> auto { return std::get<Handle_t<EntSign_t>>(mBases); }
+  template<class EntSign_t> constexpr auto GetBaseID() const -> auto
+  {
+    return Handle_t<EntSign_t>{ mBases[TMPL::Sequence::IndexOf_v<EntSign_t, Bases_t>] };
+  }
 
-  constexpr auto GetComponentIDs() const -> ComponentIDs_t { return mComponentIDs; }
+  constexpr auto GetComponentIDs() const -> ComponentIDs_t
+  {
+    return TMPL::Sequence::Unpacker_t<Components_t>::Call(
+      [&]<class... Cmps_t>() { return ComponentIDs_t{ GetComponentID<Cmps_t>()... }; });
+  }
 
-  constexpr auto GetBaseIDs() const -> BasesIDs_t { return mBases; }
+  constexpr auto GetBaseIDs() const -> BasesIDs_t
+  {
+    return TMPL::Sequence::Unpacker_t<Bases_t>::Call(
+      [&]<class... Bs_t>() { return BasesIDs_t{ GetBaseID<Bs_t>()... }; });
+  }
 
   constexpr auto GetParentID() const -> auto { return mParent; }
 
-  constexpr auto SetParentID(auto parent_id) -> void { mParent = parent_id; }
+  template<class Sign_t> constexpr auto SetParentID(Handle_t<Sign_t> parent_id) -> void
+  {
+    if constexpr (!std::is_empty_v<ParentID_t>) {
+      mParent = { TMPL::Sequence::IndexOf_v<Sign_t, Signatures_t>, parent_id.GetIndex() };
+    }
+  }
+
+  constexpr auto SetParentID(ParentID_t parent) -> void { mParent = parent; }
 
   constexpr auto SetBasesIDs(auto bs_ids) -> void
   {
     TMPL::Sequence::ForEach_t<Bases_t>::Do(
-      [&]<class T>() { std::get<Handle_t<T>>(mBases) = std::get<Handle_t<T>>(bs_ids); });
+      [&]<class T>() { mBases[TMPL::Sequence::IndexOf_v<T, Bases_t>] = std::get<Handle_t<T>>(bs_ids).GetIndex(); });
   }
 
 private:
   template<template<class...> class TList_t, class... Cmps_t>
   constexpr explicit Entity_t(TList_t<Cmps_t...>, [[maybe_unused]] auto cmp_ids, auto parent_id)
-    : mComponentIDs{ std::get<Handle_t<Cmps_t>>(cmp_ids)... }
-    , mParent{ parent_id }
+    : mComponentIDs{ std::get<Handle_t<Cmps_t>>(cmp_ids).GetIndex()... }
   {
+    SetParentID(parent_id);
   }
 
-  ComponentIDs_t  mComponentIDs{};
-  BasesIDs_t      mBases{};
-  ParentVariant_t mParent{};
+  // the links are kept as raw indices, std::tuple is not trivially copyable
+  using IDs_t     = std::array<index_type, TMPL::Sequence::Size_v<Components_t>>;
+  using BaseIDs_t = std::array<index_type, TMPL::Sequence::Size_v<Bases_t>>;
+
+  IDs_t                            mComponentIDs{};
+  [[no_unique_address]] BaseIDs_t  mBases{};
+  [[no_unique_address]] ParentID_t mParent{};
+};
+
+// rows hold nothing but the words of their links, so they are copied as raw
+// bytes and used in place from world images
+template<class Config_t> struct SnapshotBlob<Entity_t<Config_t>> : std::true_type
+{
+  static_assert(std::is_trivially_copyable_v<Entity_t<Config_t>>, "Entity rows are copied as raw bytes");
 };
 
 } // namespace ECS
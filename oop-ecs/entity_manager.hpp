@@ -1,9 +1,12 @@
 #pragma once
 
 #include "helpers.hpp"
+#include "snapshot.hpp"
+#include "stats.hpp"
 #include "traits.hpp"
 #include "type_aliases.hpp"
 
+#include <cstddef>
 #include <tuple>
 
 namespace ECS {
@@ -16,18 +19,28 @@ struct EntityManager_t final
 public:
   using Self_t                        = EntityManager_t;
   using Base_t                        = typename Config_t::base;
+  using index_type                    = typename Config_t::index_type;
+  template<class T> using Handle_t    = ECS::Handle_t<T, index_type>;
   template<class T> using entity_type = typename Config_t::template entity_type<T>;
-  template<class T> using EntityID_t  = ID_t<entity_type<T>>;
+  template<class T> using EntityID_t  = ID_t<entity_type<T>, index_type>;
 
   constexpr explicit EntityManager_t()
     : Base_t{}
   {
   }
 
+  constexpr explicit EntityManager_t(const auto& alloc)
+    : Base_t{ alloc }
+  {
+  }
+
+  // bases with a row of their own, none with virtual bases
+  template<class T> using bases_type = typename entity_type<T>::Bases_t;
+
   template<class EntSig_t> constexpr auto Create(auto cmp_ids) -> auto
   {
     auto id{ CreateParent<EntSig_t>(cmp_ids) };
-    CreateBases(Traits::Bases_t<EntSig_t>{}, id, cmp_ids);
+    CreateBases(bases_type<EntSig_t>{}, id, cmp_ids);
     return id;
   }
 
@@ -35,15 +48,15 @@ public:
   template<class EntSig_t> constexpr auto Destroy(Handle_t<EntSig_t> e) -> void
   {
     auto& ent{ GetEntity(e) };
-    DestroyBases(Traits::Bases_t<EntSig_t>{}, ent);
+    DestroyBases(bases_type<EntSig_t>{}, ent);
     DestroyRaw(e);
   }
 
   template<class DestSig_t, class EntSig_t> constexpr auto TransformTo(Handle_t<EntSig_t> e, auto cmp_ids) -> auto
   {
     using SrcSig_t = EntSig_t;
-    using DestBs_t = Traits::Bases_t<DestSig_t>;
-    using SrcBs_t  = Traits::Bases_t<SrcSig_t>;
+    using DestBs_t = bases_type<DestSig_t>;
+    using SrcBs_t  = bases_type<SrcSig_t>;
     using RmBs_t   = TMPL::Sequence::Difference_t<SrcBs_t, DestBs_t>;
     using Bs_t     = TMPL::Sequence::Difference_t<SrcBs_t, RmBs_t>;
     using MkBs_t   = TMPL::Sequence::Difference_t<DestBs_t, SrcBs_t>;
@@ -61,6 +74,40 @@ public:
     return id;
   }
 
+  // marks must flag the parent rows and the base rows of the same entities
+  template<class EntSig_t> constexpr auto EraseMarked(const auto& marks, Compaction_t compaction) -> void
+  {
+    Base_t::template GetRequiredContainer<entity_type<EntSig_t>>().erase_marked(marks, compaction);
+  }
+
+  // makes room for count more entities of EntSig_t and their bases
+  template<class EntSig_t> constexpr auto Reserve(std::size_t count) -> void
+  {
+    ReserveMore(Base_t::template GetRequiredContainer<entity_type<EntSig_t>>(), count);
+    TMPL::Sequence::ForEach_t<bases_type<EntSig_t>>::Do(
+      [&]<class Bs_t>() { ReserveMore(this->template GetRequiredContainer<entity_type<Bs_t>>(), count); });
+  }
+
+  template<class EntSig_t> constexpr auto Save(SnapshotWriter_t& out) const -> void
+  {
+    Base_t::template GetRequiredContainer<entity_type<EntSig_t>>().save(out);
+  }
+
+  template<class EntSig_t> constexpr auto Load(SnapshotReader_t& in) -> bool
+  {
+    return Base_t::template GetRequiredContainer<entity_type<EntSig_t>>().load(in);
+  }
+
+  template<class EntSig_t> constexpr auto Borrow(ImageReader_t& in) -> bool
+  {
+    return Base_t::template GetRequiredContainer<entity_type<EntSig_t>>().borrow(in);
+  }
+
+  template<class EntSig_t> constexpr auto GetStats() const -> ContainerStats_t
+  {
+    return MakeContainerStats(TypeName<EntSig_t>(), Base_t::template GetRequiredContainer<entity_type<EntSig_t>>());
+  }
+
   template<class EntSig_t> constexpr auto GetEntity(Handle_t<EntSig_t> e) const -> const auto&
   {
     return Base_t::template operator[]<entity_type<EntSig_t>>(EntityID_t<EntSig_t>{ e.GetIndex() });
@@ -74,7 +121,12 @@ public:
   template<class EntSig_t> constexpr auto GetHandle(size_t pos) const -> auto
   {
     auto& base{ Base_t::template GetRequiredContainer<entity_type<EntSig_t>>() };
-    return Handle_t{ base.get_key(pos) };
+    return ECS::Handle_t{ base.get_key(pos) };
+  }
+
+  template<class EntSig_t> constexpr auto GetEntities() const -> const auto&
+  {
+    return Base_t::template GetRequiredContainer<entity_type<EntSig_t>>();
   }
 
 private:
@@ -83,23 +135,24 @@ private:
     Base_t::template erase<entity_type<EntSig_t>>(EntityID_t<EntSig_t>{ e.GetIndex() });
   }
 
-  template<class EntSig_t> constexpr auto CreateRawEntity(auto... args) -> auto&
+  template<class EntSig_t> constexpr auto CreateRawEntity(auto... args) -> auto
   {
-    using ReqEntity_t = entity_type<EntSig_t>;
-    return Base_t::template emplace_back<ReqEntity_t>(args...);
+    auto& base{ Base_t::template GetRequiredContainer<entity_type<EntSig_t>>() };
+    base.emplace_back(args...);
+    return ECS::Handle_t{ base.back_key() };
   }
 
   template<class EntSig_t> constexpr auto CreateBase(auto cmp_ids, auto parent_id) -> auto
   {
-    return Handle_t{ CreateRawEntity<EntSig_t>(cmp_ids, parent_id).key() };
+    return CreateRawEntity<EntSig_t>(cmp_ids, parent_id);
   }
 
   template<class EntSig_t> constexpr auto CreateParent(auto cmp_ids) -> auto
   {
-    auto& slot{ CreateRawEntity<EntSig_t>(cmp_ids) };
-    slot.value().SetParentID(Handle_t{ slot.key() });
+    auto id{ CreateRawEntity<EntSig_t>(cmp_ids) };
+    GetEntity(id).SetParentID(id);
 
-    return Handle_t{ slot.key() };
+    return id;
   }
 
   template<template<class...> class TList_t, class... Bases_t, class Tp = std::tuple<>>
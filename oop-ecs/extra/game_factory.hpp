@@ -1,9 +1,12 @@
 #pragma once
 
-#include <format>
+#include <cstddef>
+#include <utility>
 
 #include <nlohmann/json.hpp>
 
+#include "prefab_cache.hpp"
+#include "scene_loader.hpp"
 #include "tmpl/sequence.hpp"
 #include "traits.hpp"
 
@@ -11,19 +14,40 @@ template <class ECSMan_t> struct GameFactory_t {
 
   using json = nlohmann::json;
 
+  explicit GameFactory_t(ECSMan_t &ecs_man, json config = {})
+      : mECSMan(ecs_man), mConfig(std::move(config)), mPrefabs(mConfig) {}
+
+  // replaces the config and decodes its prefabs again
+  auto ReloadConfig(json config) -> void {
+    mConfig = std::move(config);
+    mPrefabs.Reload(mConfig);
+  }
+
   constexpr auto LoadScene(const json &scene) const -> void {
     for (auto [k, j] : scene.items()) {
       int i{std::stoi(k)};
-      TMPL::Sequence::ForEach_t<typename ECSMan_t::EntitySignatures_t>::Do(
+      TMPL::Sequence::ForEach_t<typename ECSMan_t::signatures_type>::Do(
           [&]<class T>() {
             if (i == TMPL::Sequence::IndexOf_v<
-                         T, typename ECSMan_t::EntitySignatures_t>) {
+                         T, typename ECSMan_t::signatures_type>) {
               EntityFromJSON<T>(j);
             }
           });
     }
   }
 
+  // Same scenes without building the document, entities are created in
+  // batches per signature and then configured as EntityFromJSON does, see
+  // ECS::SceneLoader_t.
+  template <class Input_t>
+  auto StreamScene(Input_t &&input, ECS::JobSystem_t *jobs = nullptr) const
+      -> bool {
+    auto configure = [](auto e, const json &j) { ConfigureEntityFromJson(e, j); };
+    ECS::SceneLoader_t<ECSMan_t, decltype(configure)> loader{mECSMan, 4096,
+                                                             jobs, configure};
+    return loader.Load(std::forward<Input_t>(input));
+  }
+
   template <class EntSig_t, class... Args_t>
   constexpr auto EntityFromJSON(const json &j, Args_t &&...args) const -> auto {
     using Components_t = TMPL::Sequence::Difference_t<
@@ -40,20 +64,33 @@ template <class ECSMan_t> struct GameFactory_t {
     return e;
   }
 
+  // copies the components decoded from the config once, see
+  // ECS::PrefabCache_t
   template <class EntSig_t, class... Args_t>
   constexpr auto EntityFromConfig(Args_t &&...args) const -> auto {
-    constexpr auto type_id{
-        TMPL::Sequence::IndexOf_v<EntSig_t,
-                                  typename ECSMan_t::EntitySignatures_t>};
-    if (mConfig.contains(std::format("{}", type_id))) {
-      return EntityFromJSON<EntSig_t>(mConfig[std::to_string(type_id)],
-                                      std::forward<Args_t>(args)...);
-    } else {
-      return mECSMan.template CreateEntity<EntSig_t>();
+    auto e = mPrefabs.template Instantiate<EntSig_t>(
+        mECSMan, std::forward<Args_t>(args)...);
+    if (const auto *j = mPrefabs.template GetConfig<EntSig_t>()) {
+      ConfigureEntityFromJson(e, *j);
     }
+
+    return e;
+  }
+
+  template <class EntSig_t>
+  auto EntitiesFromConfig(std::size_t count) const -> auto {
+    auto es = mPrefabs.template Instantiate<EntSig_t>(mECSMan, count);
+    if (const auto *j = mPrefabs.template GetConfig<EntSig_t>()) {
+      for (auto e : es) {
+        ConfigureEntityFromJson(e, *j);
+      }
+    }
+
+    return es;
   }
 
 protected:
   ECSMan_t &mECSMan;
-  const json mConfig{};
+  json mConfig{};
+  ECS::PrefabCache_t<ECSMan_t> mPrefabs{};
 };
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include "traits.hpp"
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ECS {
+
+// Prototypes of the stored components of every signature, decoded once from
+// a config as GameFactory_t::EntityFromConfig reads it: an object whose keys
+// are indices in the signature list. Spawning copies the prototypes into the
+// columns, the config is not looked at again until Reload.
+template<class ECSMan_t> struct PrefabCache_t
+{
+  using json         = nlohmann::json;
+  using Signatures_t = typename ECSMan_t::signatures_type;
+
+  template<class T> using handle_type = typename ECSMan_t::template handle_type<T>;
+
+  static constexpr std::size_t signatures{ Seq::Size_v<Signatures_t> };
+
+  PrefabCache_t() = default;
+
+  explicit PrefabCache_t(const json& config) { Reload(config); }
+
+  // decodes the prototypes of a new config, those of the signatures missing
+  // from it are dropped
+  auto Reload(const json& config) -> void
+  {
+    Seq::ForEach_t<Signatures_t>::Do([&]<class EntSig_t>() {
+      constexpr auto index{ Seq::IndexOf_v<EntSig_t, Signatures_t> };
+      auto&          prefab{ std::get<index>(mPrefabs) };
+      auto           entry{ config.is_object() ? config.find(std::to_string(index)) : config.end() };
+      if (entry == config.end()) {
+        prefab.reset();
+        mConfigs[index] = nullptr;
+      } else {
+        Seq::Unpacker_t<Traits::StoredComponents_t<EntSig_t>>::Call(
+          [&]<class... Cmps_t>() { prefab.emplace(entry->template get<Cmps_t>()...); });
+        mConfigs[index] = *entry;
+      }
+    });
+  }
+
+  template<class EntSig_t> auto HasPrefab() const -> bool
+  {
+    return std::get<Seq::IndexOf_v<EntSig_t, Signatures_t>>(mPrefabs).has_value();
+  }
+
+  // config the prototypes were decoded from, nullptr without prefab
+  template<class EntSig_t> auto GetConfig() const -> const json*
+  {
+    return HasPrefab<EntSig_t>() ? &mConfigs[Seq::IndexOf_v<EntSig_t, Signatures_t>] : nullptr;
+  }
+
+  // Creates an entity from the prototypes, the components given replace
+  // theirs. Without prefab the components are default constructed.
+  template<class EntSig_t, class... Args_t>
+    requires(!std::integral<std::remove_cvref_t<Args_t>> && ...)
+  auto Instantiate(ECSMan_t& ecs_man, Args_t&&... args) const -> handle_type<EntSig_t>
+  {
+    const auto& prefab{ std::get<Seq::IndexOf_v<EntSig_t, Signatures_t>>(mPrefabs) };
+    if (!prefab) {
+      return ecs_man.template CreateEntity<EntSig_t>(std::forward<Args_t>(args)...);
+    }
+    using Prototypes_t =
+      Seq::Difference_t<Traits::StoredComponents_t<EntSig_t>, TMPL::TypeList_t<std::remove_cvref_t<Args_t>...>>;
+    return Seq::Unpacker_t<Prototypes_t>::Call([&]<class... Cmps_t>() {
+      return ecs_man.template CreateEntity<EntSig_t>(std::get<Cmps_t>(*prefab)..., std::forward<Args_t>(args)...);
+    });
+  }
+
+  // creates count entities at once, the prototypes copied straight into the
+  // reserved columns
+  template<class EntSig_t>
+  auto Instantiate(ECSMan_t& ecs_man, std::size_t count) const -> std::vector<handle_type<EntSig_t>>
+  {
+    const auto& prefab{ std::get<Seq::IndexOf_v<EntSig_t, Signatures_t>>(mPrefabs) };
+    if (!prefab) {
+      return ecs_man.template CreateEntities<EntSig_t>(count, [](std::size_t) { return std::tuple{}; });
+    }
+    return ecs_man.template CreateEntities<EntSig_t>(count, [&](std::size_t) -> const auto& { return *prefab; });
+  }
+
+private:
+  template<class EntSig_t>
+  using ToPrefab_t = std::type_identity<std::optional<Seq::As_t<std::tuple, Traits::StoredComponents_t<EntSig_t>>>>;
+
+  Seq::As_t<std::tuple, Seq::Map_t<Signatures_t, ToPrefab_t>> mPrefabs{};
+  std::array<json, signatures>                                mConfigs{};
+};
+
+} // namespace ECS
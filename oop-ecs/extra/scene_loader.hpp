@@ -0,0 +1,338 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include "helpers.hpp"
+#include "job_system.hpp"
+#include "traits.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <iterator>
+#include <cstddef>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ECS {
+
+// Streaming scene loader. A scene is a JSON object whose keys are indices in
+// the signature list and whose values are arrays of entities, or a single
+// entity as GameFactory_t::LoadScene reads them:
+//   { "0": [ { "x": 1, "y": 2 }, ... ], "2": { "x": 3, "y": 4 } }
+// Every stored component of the signature is taken from the entity object
+// with nlohmann::from_json, unknown keys are skipped.
+// The document is never held whole: each entity object is built on its own
+// and its components decoded in the batch of its signature, a full batch is
+// created at once with CreateEntities, which reserves its columns and moves
+// the components there.
+// With a JobSystem_t the entity objects of a batch are kept and the batches
+// of every signature are decoded together in parallel, then created in
+// order on the calling thread.
+// A hook, called as hook(handle, entity object) for each entity created,
+// sets up what the components do not hold; the entity objects of a batch
+// are kept for it.
+struct NoSceneHook_t
+{};
+
+template<class ECSMan_t, class Hook_t = NoSceneHook_t> struct SceneLoader_t
+{
+  using json         = nlohmann::json;
+  using Signatures_t = typename ECSMan_t::signatures_type;
+
+  static constexpr std::size_t signatures{ Seq::Size_v<Signatures_t> };
+  static constexpr std::size_t no_signature{ signatures };
+
+  explicit SceneLoader_t(ECSMan_t&    ecs_man,
+                         std::size_t  batch_size = 4096,
+                         JobSystem_t* jobs       = nullptr,
+                         Hook_t       hook       = Hook_t{})
+    : mECSMan{ ecs_man }
+    , mJobs{ jobs }
+    , mBatchSize{ std::max(batch_size, std::size_t{ 1 }) }
+    , mHook{ std::move(hook) }
+  {
+  }
+
+  SceneLoader_t(const SceneLoader_t&)                    = delete;
+  auto operator=(const SceneLoader_t&) -> SceneLoader_t& = delete;
+
+  // Reads a scene from anything nlohmann::json::sax_parse accepts. On a
+  // syntax error, or an entity whose components cannot be decoded, returns
+  // false, the entities of the batches already created are kept. Built
+  // without exceptions nlohmann::json aborts on such an entity instead.
+  template<class Input_t> auto Load(Input_t&& input) -> bool
+  {
+    auto ok{ json::sax_parse(std::forward<Input_t>(input), this) && FlushAll() };
+    for (auto& batch : mBatches) {
+      batch.clear();
+    }
+    std::apply([](auto&... decoded) { (std::apply([](auto&... columns) { (columns.clear(), ...); }, decoded), ...); },
+               mDecoded);
+    mPending = {};
+    mStack.clear();
+    mDepth   = 0;
+    mInArray = false;
+    mGroup   = no_signature;
+    return ok;
+  }
+
+  // entities created by the loader so far
+  auto Loaded() const -> std::size_t { return mLoaded; }
+
+  // SAX events
+  auto null() -> bool { return Value(nullptr); }
+
+  auto boolean(bool value) -> bool { return Value(value); }
+
+  auto number_integer(json::number_integer_t value) -> bool { return Value(value); }
+
+  auto number_unsigned(json::number_unsigned_t value) -> bool { return Value(value); }
+
+  auto number_float(json::number_float_t value, const json::string_t&) -> bool { return Value(value); }
+
+  auto string(json::string_t& value) -> bool { return Value(std::move(value)); }
+
+  auto binary(json::binary_t& value) -> bool { return Value(json::binary(std::move(value))); }
+
+  auto start_object(std::size_t) -> bool { return Open(json::value_t::object); }
+
+  auto end_object() -> bool { return Close(); }
+
+  auto start_array(std::size_t) -> bool { return Open(json::value_t::array); }
+
+  auto end_array() -> bool { return Close(); }
+
+  auto key(json::string_t& key) -> bool
+  {
+    if (!mStack.empty()) {
+      mKey = std::move(key);
+    } else if (mDepth == 1) {
+      mGroup = ParseSignature(key);
+    }
+    return true;
+  }
+
+  auto parse_error(std::size_t, const std::string&, const json::exception&) -> bool { return false; }
+
+private:
+  template<class EntSig_t> using Components_t = Traits::StoredComponents_t<EntSig_t>;
+  template<class T> using ToVector_t           = std::type_identity<std::vector<T>>;
+
+  // decoded components of a batch, one vector per column
+  template<class EntSig_t> struct ToDecoded_t
+  {
+    using type = Seq::As_t<std::tuple, Seq::Map_t<Components_t<EntSig_t>, ToVector_t>>;
+  };
+
+  static constexpr bool has_hook{ !std::is_same_v<Hook_t, NoSceneHook_t> };
+
+  static auto ParseSignature(const std::string& key) -> std::size_t
+  {
+    std::size_t index{ no_signature };
+    auto [end, error]{ std::from_chars(key.data(), key.data() + key.size(), index) };
+    if (error != std::errc{} || end != key.data() + key.size() || index >= signatures) {
+      return no_signature;
+    }
+    return index;
+  }
+
+  // Depth 1 is the scene, depth 2 a signature value, an entity when it is an
+  // object or a list of entities when it is an array.
+  auto Open(json::value_t type) -> bool
+  {
+    ++mDepth;
+    if (!mStack.empty()) {
+      mStack.push_back(&Insert(json(type)));
+    } else if (mGroup == no_signature) {
+      return true;
+    } else if (mDepth == 2 && type == json::value_t::array) {
+      mInArray = true;
+    } else if (type == json::value_t::object && (mDepth == 2 || (mDepth == 3 && mInArray))) {
+      StartEntity();
+    }
+    return true;
+  }
+
+  auto Close() -> bool
+  {
+    auto ok{ true };
+    if (!mStack.empty()) {
+      mStack.pop_back();
+      if (mStack.empty()) {
+        ok = Queue();
+      }
+    } else if (mDepth == 2) {
+      mInArray = false;
+    }
+    --mDepth;
+    return ok;
+  }
+
+  auto Value(json value) -> bool
+  {
+    if (!mStack.empty()) {
+      Insert(std::move(value));
+    }
+    return true;
+  }
+
+  auto Insert(json value) -> json&
+  {
+    auto& parent{ *mStack.back() };
+    if (parent.is_array()) {
+      parent.push_back(std::move(value));
+      return parent.back();
+    }
+    return parent[mKey] = std::move(value);
+  }
+
+  // Without jobs nor hook the entity object is reused: the fields of the
+  // previous entity are marked discarded, assigned again in place, and those
+  // left are erased once the entity is complete. Entities of a scene share
+  // their keys, so no field is allocated after the first entity.
+  auto StartEntity() -> void
+  {
+    if (mEntity.is_object()) {
+      for (auto& field : mEntity) {
+        field = json(json::value_t::discarded);
+      }
+    } else {
+      mEntity = json(json::value_t::object);
+    }
+    mStack.push_back(&mEntity);
+  }
+
+  // false stops the parse when the entity cannot be decoded
+  auto Queue() -> bool
+  {
+    for (auto field{ mEntity.begin() }; field != mEntity.end();) {
+      field = field->is_discarded() ? mEntity.erase(field) : std::next(field);
+    }
+    auto ok{ true };
+    if (mJobs != nullptr) {
+      mBatches[mGroup].push_back(std::move(mEntity));
+    } else {
+      const auto* ent{ &mEntity };
+      if constexpr (has_hook) {
+        ent = &mBatches[mGroup].emplace_back(std::move(mEntity));
+      }
+      Dispatch(mGroup, [&]<class EntSig_t>() { ok = TryDecode<EntSig_t>(*ent); });
+    }
+    if (ok && ++mPending[mGroup] >= mBatchSize) {
+      if (mJobs != nullptr) {
+        ok = FlushAll();
+      } else {
+        Flush(mGroup);
+      }
+    }
+    return ok;
+  }
+
+  // With jobs the queued entities are decoded in parallel, one job per
+  // signature, and all the signatures are created unless one of them could
+  // not be decoded.
+  auto FlushAll() -> bool
+  {
+    if (mJobs != nullptr) {
+      std::array<bool, signatures> failed{};
+      mJobs->ParallelFor(signatures, 1, [&](std::size_t first, std::size_t last) {
+        for (; first < last; ++first) {
+          Dispatch(first, [&]<class EntSig_t>() {
+            for (const auto& ent : mBatches[first]) {
+              if (!TryDecode<EntSig_t>(ent)) {
+                failed[first] = true;
+                return;
+              }
+            }
+          });
+        }
+      });
+      if (std::ranges::any_of(failed, [](bool f) { return f; })) {
+        return false;
+      }
+    }
+    for (std::size_t group{}; group < signatures; ++group) {
+      Flush(group);
+    }
+    return true;
+  }
+
+  auto Flush(std::size_t group) -> void
+  {
+    if (mPending[group] != 0) {
+      Dispatch(group, [&]<class EntSig_t>() { Create<EntSig_t>(); });
+    }
+  }
+
+  template<class EntSig_t> auto Decode(const json& ent) -> void
+  {
+    std::apply(
+      [&]<class... Cmps_t>(std::vector<Cmps_t>&... columns) { (columns.push_back(ent.template get<Cmps_t>()), ...); },
+      std::get<Seq::IndexOf_v<EntSig_t, Signatures_t>>(mDecoded));
+  }
+
+  // false on a missing or mistyped field, the columns are left uneven until
+  // Load clears them
+  template<class EntSig_t> auto TryDecode(const json& ent) -> bool
+  {
+#if defined(__cpp_exceptions)
+    try {
+      Decode<EntSig_t>(ent);
+    } catch (const json::exception&) {
+      return false;
+    }
+#else
+    Decode<EntSig_t>(ent);
+#endif
+    return true;
+  }
+
+  // the decoded components are moved to their columns, then the hook sees
+  // each entity with its object
+  template<class EntSig_t> auto Create() -> void
+  {
+    constexpr auto group{ Seq::IndexOf_v<EntSig_t, Signatures_t> };
+    std::apply(
+      [&](auto&... columns) {
+        auto es{ mECSMan.template CreateEntities<EntSig_t>(
+          mPending[group], [&](std::size_t i) { return std::tuple{ std::move(columns[i])... }; }) };
+        if constexpr (has_hook) {
+          for (std::size_t i{}; i < es.size(); ++i) {
+            mHook(es[i], std::as_const(mBatches[group][i]));
+          }
+        }
+        (columns.clear(), ...);
+      },
+      std::get<group>(mDecoded));
+    mBatches[group].clear();
+    mLoaded += std::exchange(mPending[group], 0);
+  }
+
+  static auto Dispatch(std::size_t group, auto&& fn) -> void
+  {
+    Seq::Unpacker_t<Signatures_t>::Call([&]<class... Signs_t>() {
+      ((group == Seq::IndexOf_v<Signs_t, Signatures_t> && (fn.template operator()<Signs_t>(), true)) || ...);
+    });
+  }
+
+  ECSMan_t&                                                    mECSMan;
+  JobSystem_t*                                                 mJobs{};
+  std::size_t                                                  mBatchSize{};
+  [[no_unique_address]] Hook_t                                 mHook{};
+  std::size_t                                                  mLoaded{};
+  std::array<std::vector<json>, signatures>                    mBatches{};
+  std::array<std::size_t, signatures>                          mPending{};
+  Seq::As_t<std::tuple, Seq::Map_t<Signatures_t, ToDecoded_t>> mDecoded{};
+  std::vector<json*>                                           mStack{};
+  json                                                         mEntity{};
+  std::string                                                  mKey{};
+  std::size_t                                                  mDepth{};
+  std::size_t                                                  mGroup{ no_signature };
+  bool                                                         mInArray{};
+};
+
+} // namespace ECS
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 
@@ -62,6 +65,46 @@ struct Uncopyable_t
   constexpr auto operator=(const Uncopyable_t&) -> Uncopyable_t& = delete;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// ReserveMore
+///////////////////////////////////////////////////////////////////////////////
+
+// makes room for count more elements without giving up the geometric growth,
+// so reserving before every small batch does not reallocate every time
+constexpr auto
+ReserveMore(auto& container, std::size_t count) -> void
+{
+  auto required{ container.size() + count };
+  if (required > container.capacity()) {
+    container.reserve(std::max(required, container.capacity() * 2));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// TypeName
+///////////////////////////////////////////////////////////////////////////////
+
+// name of T as the compiler spells it, RTTI is not needed
+template<class T>
+constexpr auto
+TypeName() -> std::string_view
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  std::string_view name{ __FUNCSIG__ };
+  auto             first{ name.find("TypeName<") + 9 };
+  auto             last{ name.rfind(">(void)") };
+#else
+  // GCC ends T with a semicolon, Clang with the bracket
+  std::string_view name{ __PRETTY_FUNCTION__ };
+  auto             first{ name.find("T = ") + 4 };
+  auto             last{ std::min(name.find(';', first), name.rfind(']')) };
+#endif
+  return name.substr(first, last - first);
+}
+
+// the same name, computed at compile time wherever it is used
+template<class T> inline constexpr std::string_view TypeName_v{ TypeName<T>() };
+
 ///////////////////////////////////////////////////////////////////////////////
 // lambda overloaded
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace ECS {
+
+// Contiguous vector that can also borrow its elements from memory it does
+// not own, such as a world image mapped with MAP_PRIVATE: the elements are
+// changed in place and the first growth moves them to storage of its own.
+// Borrowed elements are never destroyed, so only trivially destructible types
+// can be borrowed.
+template<class T, class Alloc_t = std::allocator<T>> struct ImageVector_t
+{
+  using allocator_type         = Alloc_t;
+  using value_type             = T;
+  using size_type              = std::size_t;
+  using difference_type        = std::ptrdiff_t;
+  using reference              = T&;
+  using const_reference        = const T&;
+  using pointer                = T*;
+  using const_pointer          = const T*;
+  using iterator               = T*;
+  using const_iterator         = const T*;
+  using reverse_iterator       = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  constexpr explicit ImageVector_t(const Alloc_t& alloc = Alloc_t{})
+    : mAlloc{ alloc }
+  {
+  }
+
+  constexpr ImageVector_t(ImageVector_t&& other) noexcept
+    : mAlloc{ other.mAlloc }
+    , mData{ std::exchange(other.mData, nullptr) }
+    , mSize{ std::exchange(other.mSize, 0) }
+    , mCapacity{ std::exchange(other.mCapacity, 0) }
+  {
+  }
+
+  // the allocators are expected to be equal, as it happens with std::vector
+  // when they do not propagate
+  constexpr auto operator=(ImageVector_t&& other) noexcept -> ImageVector_t&
+  {
+    Release();
+    mData     = std::exchange(other.mData, nullptr);
+    mSize     = std::exchange(other.mSize, 0);
+    mCapacity = std::exchange(other.mCapacity, 0);
+
+    return *this;
+  }
+
+  ImageVector_t(const ImageVector_t&)                    = delete;
+  auto operator=(const ImageVector_t&) -> ImageVector_t& = delete;
+
+  ~ImageVector_t() { Release(); }
+
+  // drops the elements and uses the ones of values, which must outlive the
+  // vector or its next growth
+  constexpr auto borrow(std::span<T> values) -> void
+  {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be borrowed");
+    static_assert(std::is_trivially_destructible_v<T>, "Only trivially destructible elements can be borrowed");
+    Release();
+    mData = values.data();
+    mSize = values.size();
+  }
+
+  constexpr auto is_borrowed() const -> bool { return mCapacity == 0 && mData != nullptr; }
+
+  template<class... Args_t> constexpr auto emplace_back(Args_t&&... args) -> reference
+  {
+    if (mSize == capacity()) {
+      Reallocate(std::max(mSize * 2, size_type{ 1 }));
+    }
+    auto* value{ std::construct_at(mData + mSize, std::forward<Args_t>(args)...) };
+    ++mSize;
+    return *value;
+  }
+
+  constexpr auto push_back(const T& value) -> void { emplace_back(value); }
+
+  constexpr auto push_back(T&& value) -> void { emplace_back(std::move(value)); }
+
+  constexpr auto pop_back() -> void
+  {
+    --mSize;
+    if (!is_borrowed()) {
+      std::destroy_at(mData + mSize);
+    }
+  }
+
+  constexpr auto clear() -> void
+  {
+    if (is_borrowed()) {
+      mData = nullptr;
+      mSize = 0;
+    }
+    while (mSize != 0) {
+      pop_back();
+    }
+  }
+
+  constexpr auto resize(size_type count) -> void
+  {
+    if (count > mSize) {
+      reserve(count);
+      std::uninitialized_value_construct(mData + mSize, mData + count);
+      mSize = count;
+    }
+    while (mSize > count) {
+      pop_back();
+    }
+  }
+
+  constexpr auto reserve(size_type new_cap) -> void
+  {
+    if (new_cap > capacity()) {
+      Reallocate(new_cap);
+    }
+  }
+
+  constexpr auto shrink_to_fit() -> void
+  {
+    if (!is_borrowed() && mCapacity > mSize) {
+      Reallocate(mSize);
+    }
+  }
+
+  constexpr auto size() const -> size_type { return mSize; }
+
+  [[nodiscard]] constexpr auto empty() const -> bool { return mSize == 0; }
+
+  // borrowed elements leave no room to grow
+  constexpr auto capacity() const -> size_type { return is_borrowed() ? mSize : mCapacity; }
+
+  constexpr auto data() -> pointer { return mData; }
+
+  constexpr auto data() const -> const_pointer { return mData; }
+
+  constexpr auto operator[](size_type pos) -> reference { return mData[pos]; }
+
+  constexpr auto operator[](size_type pos) const -> const_reference { return mData[pos]; }
+
+  constexpr auto back() -> reference { return mData[mSize - 1]; }
+
+  constexpr auto back() const -> const_reference { return mData[mSize - 1]; }
+
+  constexpr auto begin() -> iterator { return mData; }
+
+  constexpr auto begin() const -> const_iterator { return mData; }
+
+  constexpr auto cbegin() const -> const_iterator { return mData; }
+
+  constexpr auto end() -> iterator { return mData + mSize; }
+
+  constexpr auto end() const -> const_iterator { return mData + mSize; }
+
+  constexpr auto cend() const -> const_iterator { return mData + mSize; }
+
+  constexpr auto rbegin() -> reverse_iterator { return reverse_iterator{ end() }; }
+
+  constexpr auto rbegin() const -> const_reverse_iterator { return const_reverse_iterator{ end() }; }
+
+  constexpr auto crbegin() const -> const_reverse_iterator { return rbegin(); }
+
+  constexpr auto rend() -> reverse_iterator { return reverse_iterator{ begin() }; }
+
+  constexpr auto rend() const -> const_reverse_iterator { return const_reverse_iterator{ begin() }; }
+
+  constexpr auto crend() const -> const_reverse_iterator { return rend(); }
+
+private:
+  using AllocTraits_t = std::allocator_traits<Alloc_t>;
+
+  // moves the elements to new storage of its own
+  constexpr auto Reallocate(size_type new_cap) -> void
+  {
+    T* data{ new_cap == 0 ? nullptr : std::to_address(AllocTraits_t::allocate(mAlloc, new_cap)) };
+    std::uninitialized_move(mData, mData + mSize, data);
+    if (!is_borrowed()) {
+      std::destroy(mData, mData + mSize);
+      Deallocate();
+    }
+    mData     = data;
+    mCapacity = new_cap;
+  }
+
+  constexpr auto Deallocate() -> void
+  {
+    if (mCapacity != 0) {
+      AllocTraits_t::deallocate(mAlloc, mData, mCapacity);
+    }
+  }
+
+  constexpr auto Release() -> void
+  {
+    clear();
+    Deallocate();
+    mData     = nullptr;
+    mCapacity = 0;
+  }
+
+  Alloc_t   mAlloc{};
+  T*        mData{};
+  size_type mSize{};
+  size_type mCapacity{};
+};
+
+} // namespace ECS
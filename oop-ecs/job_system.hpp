@@ -0,0 +1,194 @@
+#pragma once
+
+#include "helpers.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ECS {
+
+// Work-stealing thread pool. ParallelFor splits a range in chunks of grain
+// positions and deals them in contiguous blocks to one queue per thread, so
+// each thread walks neighbouring memory. A thread pops its own chunks from the
+// back and steals from the front of the others when it runs out. The calling
+// thread takes part in the work using queue 0.
+struct JobSystem_t : Uncopyable_t
+{
+  explicit JobSystem_t(std::size_t workers = DefaultWorkers(), std::size_t grain = 1024)
+    : mQueues(workers + 1)
+    , mGrain{ std::max(grain, std::size_t{ 1 }) }
+  {
+    mWorkers.reserve(workers);
+    for (std::size_t i{ 1 }; i <= workers; ++i) {
+      mWorkers.emplace_back([this, i] { WorkerLoop(i); });
+    }
+  }
+
+  ~JobSystem_t()
+  {
+    {
+      std::lock_guard lock{ mMutex };
+      mStop = true;
+    }
+    mWake.notify_all();
+    for (auto& worker : mWorkers) {
+      worker.join();
+    }
+  }
+
+  // Calls fn(first, last) for every chunk of [0, count) and returns once all
+  // of them are done.
+  template<class Fn_t> auto ParallelFor(std::size_t count, Fn_t&& fn) -> void
+  {
+    ParallelFor(count, mGrain, std::forward<Fn_t>(fn));
+  }
+
+  template<class Fn_t> auto ParallelFor(std::size_t count, std::size_t grain, Fn_t&& fn) -> void
+  {
+    grain = std::max(grain, std::size_t{ 1 });
+    if (count == 0) {
+      return;
+    }
+    if (mWorkers.empty() || count <= grain) {
+      fn(std::size_t{}, count);
+      return;
+    }
+
+    auto chunks{ (count + grain - 1) / grain };
+    using Context_t = std::remove_reference_t<Fn_t>;
+    Job_t job{ [](void* ctx, std::size_t first, std::size_t last) { (*static_cast<Context_t*>(ctx))(first, last); },
+               const_cast<void*>(static_cast<const void*>(std::addressof(fn))),
+               chunks };
+    for (std::size_t chunk{}; chunk < chunks; ++chunk) {
+      auto& queue{ mQueues[chunk * mQueues.size() / chunks] };
+      std::lock_guard lock{ queue.mMutex };
+      queue.mTasks.push_back({ &job, chunk * grain, std::min(count, (chunk + 1) * grain) });
+    }
+    mQueued.fetch_add(chunks);
+    {
+      // pairs with the check made by the workers before sleeping
+      std::lock_guard lock{ mMutex };
+    }
+    mWake.notify_all();
+
+    while (job.mPending.load(std::memory_order_acquire) != 0) {
+      if (!RunOne(std::min(WorkerIndex(), mQueues.size() - 1))) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  // threads running jobs, the calling one included
+  auto WorkerCount() const -> std::size_t { return mQueues.size(); }
+
+  auto Grain() const -> std::size_t { return mGrain; }
+
+  // 0 outside the pool, 1 to WorkerCount() - 1 inside its workers. Can be used
+  // to pick a per thread CommandBuffer_t.
+  static auto WorkerIndex() -> std::size_t { return sWorkerIndex; }
+
+  static auto DefaultWorkers() -> std::size_t
+  {
+    auto threads{ std::thread::hardware_concurrency() };
+    return threads > 1 ? threads - 1 : 0;
+  }
+
+  // pool used by ECSManager_t::ParallelForEach when none is given
+  static auto Default() -> JobSystem_t&
+  {
+    static JobSystem_t jobs{};
+    return jobs;
+  }
+
+private:
+  struct Job_t
+  {
+    using Run_t = void (*)(void*, std::size_t, std::size_t);
+
+    Run_t                    mRun{};
+    void*                    mContext{};
+    std::atomic<std::size_t> mPending{};
+  };
+
+  struct Task_t
+  {
+    Job_t*      mJob{};
+    std::size_t mFirst{};
+    std::size_t mLast{};
+  };
+
+  // one cache line each so the queue locks do not share lines
+  struct alignas(64) Queue_t
+  {
+    std::mutex         mMutex{};
+    std::deque<Task_t> mTasks{};
+  };
+
+  auto TryPop(std::size_t index, bool steal, Task_t& task) -> bool
+  {
+    auto&            queue{ mQueues[index] };
+    std::unique_lock lock{ queue.mMutex, std::try_to_lock };
+    if (!lock.owns_lock() || queue.mTasks.empty()) {
+      return false;
+    }
+    if (steal) {
+      task = queue.mTasks.front();
+      queue.mTasks.pop_front();
+    } else {
+      task = queue.mTasks.back();
+      queue.mTasks.pop_back();
+    }
+    mQueued.fetch_sub(1);
+    return true;
+  }
+
+  auto RunOne(std::size_t index) -> bool
+  {
+    Task_t task{};
+    auto   found{ TryPop(index, false, task) };
+    for (std::size_t i{ 1 }; !found && i < mQueues.size(); ++i) {
+      found = TryPop((index + i) % mQueues.size(), true, task);
+    }
+    if (found) {
+      task.mJob->mRun(task.mJob->mContext, task.mFirst, task.mLast);
+      task.mJob->mPending.fetch_sub(1, std::memory_order_release);
+    }
+    return found;
+  }
+
+  auto WorkerLoop(std::size_t index) -> void
+  {
+    sWorkerIndex = index;
+    while (true) {
+      if (RunOne(index)) {
+        continue;
+      }
+      std::unique_lock lock{ mMutex };
+      mWake.wait(lock, [&] { return mStop || mQueued.load() != 0; });
+      if (mStop) {
+        return;
+      }
+    }
+  }
+
+  static inline thread_local std::size_t sWorkerIndex{};
+
+  std::vector<Queue_t>     mQueues;
+  std::vector<std::thread> mWorkers{};
+  std::size_t              mGrain{};
+  std::atomic<std::size_t> mQueued{};
+  std::mutex               mMutex{};
+  std::condition_variable  mWake{};
+  bool                     mStop{};
+};
+
+} // namespace ECS
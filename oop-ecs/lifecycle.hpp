@@ -0,0 +1,117 @@
+#pragma once
+
+#include "type_aliases.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ECS {
+
+// A transformation records TransformedOut for the signatures the entity
+// leaves and TransformedIn for the ones it enters, since the handles of those
+// rows change. The signatures kept in between keep their handles.
+enum class Lifecycle_t : std::uint8_t
+{
+  Created,
+  Destroyed,
+  TransformedOut,
+  TransformedIn
+};
+
+// The handle of a destroyed or transformed out entity is no longer valid, it
+// can only be used as a key.
+template<class Sign_t, class Index_t = std::size_t> struct LifecycleEvent_t
+{
+  Handle_t<Sign_t, Index_t> mEntity{};
+  Lifecycle_t               mKind{};
+};
+
+// Events of one signature in recording order, at most the capacity given to
+// Observe between two drains: both buffers are reserved up front, so
+// recording never allocates, and the events past the capacity are dropped and
+// counted. They are handed out from the second buffer, so new events can be
+// recorded while the consumer changes the world.
+template<class Sign_t, class Alloc_t, class Index_t = std::size_t> struct LifecycleQueue_t
+{
+  using value_type     = LifecycleEvent_t<Sign_t, Index_t>;
+  using allocator_type = typename std::allocator_traits<Alloc_t>::template rebind_alloc<value_type>;
+
+  constexpr explicit LifecycleQueue_t(const Alloc_t& alloc = Alloc_t{})
+    : mEvents{ allocator_type{ alloc } }
+    , mDraining{ allocator_type{ alloc } }
+  {
+  }
+
+  constexpr auto Push(Handle_t<Sign_t, Index_t> e, Lifecycle_t kind) -> void
+  {
+    if (!mObserved) {
+      return;
+    }
+    if (mEvents.size() < mCapacity) {
+      mEvents.push_back({ e, kind });
+    } else {
+      ++mDropped;
+    }
+  }
+
+  constexpr auto Observe(std::size_t capacity) -> void
+  {
+    mObserved = true;
+    mCapacity = capacity;
+    mEvents.reserve(capacity);
+    mDraining.reserve(capacity);
+  }
+
+  constexpr auto Unobserve() -> void
+  {
+    mObserved = false;
+    Clear();
+  }
+
+  constexpr auto IsObserved() const -> bool { return mObserved; }
+
+  constexpr auto Capacity() const -> std::size_t { return mCapacity; }
+
+  // events dropped since the last drain because the queue was full
+  constexpr auto Dropped() const -> std::size_t { return mDropped; }
+
+  // drops the pending events, still observing
+  constexpr auto Clear() -> void
+  {
+    mEvents.clear();
+    mDropped = 0;
+  }
+
+  // Calls fn once with all the events recorded so far, and with the number of
+  // events dropped when fn takes it. After an overflow the events kept are
+  // the oldest ones, the consumer has to look at the world again.
+  template<class Fn_t> constexpr auto Drain(Fn_t&& fn) -> std::size_t
+  {
+    std::swap(mEvents, mDraining);
+    auto count{ mDraining.size() };
+    auto dropped{ std::exchange(mDropped, 0) };
+    if constexpr (std::is_invocable_v<Fn_t, std::span<const value_type>, std::size_t>) {
+      if (count != 0 || dropped != 0) {
+        fn(std::span<const value_type>{ mDraining }, dropped);
+      }
+    } else if (count != 0) {
+      fn(std::span<const value_type>{ mDraining });
+    }
+    mDraining.clear();
+    return count;
+  }
+
+private:
+  std::vector<value_type, allocator_type> mEvents;
+  std::vector<value_type, allocator_type> mDraining;
+  std::size_t                             mCapacity{};
+  std::size_t                             mDropped{};
+  bool                                    mObserved{};
+};
+
+} // namespace ECS
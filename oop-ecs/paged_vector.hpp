@@ -0,0 +1,238 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace ECS {
+
+// Vector made of fixed size pages. Growing only allocates a new page, so the
+// elements are never relocated and references to them stay valid until they
+// are erased.
+template<class T, std::size_t PageBytes, class Alloc_t = std::allocator<T>> struct PagedVector_t
+{
+  using allocator_type  = Alloc_t;
+  using value_type      = T;
+  using size_type       = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference       = T&;
+  using const_reference = const T&;
+  using pointer         = T*;
+  using const_pointer   = const T*;
+
+  static constexpr size_type page_size{ std::bit_floor(std::max(PageBytes / sizeof(T), std::size_t{ 1 })) };
+
+  template<bool IsConst> struct Iterator_t
+  {
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = std::conditional_t<IsConst, const T*, T*>;
+    using reference         = std::conditional_t<IsConst, const T&, T&>;
+    using Pages_t           = std::conditional_t<IsConst, T* const*, T**>;
+
+    constexpr Iterator_t() = default;
+    constexpr Iterator_t(Pages_t pages, size_type pos)
+      : mPages{ pages }
+      , mPos{ pos }
+    {
+    }
+
+    constexpr operator Iterator_t<true>() const { return { mPages, mPos }; }
+
+    constexpr auto operator*() const -> reference { return mPages[mPos / page_size][mPos % page_size]; }
+    constexpr auto operator->() const -> pointer { return std::addressof(**this); }
+    constexpr auto operator[](difference_type n) const -> reference { return *(*this + n); }
+
+    constexpr auto operator++(int) -> Iterator_t { return { mPages, mPos++ }; }
+    constexpr auto operator--(int) -> Iterator_t { return { mPages, mPos-- }; }
+
+    constexpr auto operator++() -> Iterator_t&
+    {
+      ++mPos;
+      return *this;
+    }
+
+    constexpr auto operator--() -> Iterator_t&
+    {
+      --mPos;
+      return *this;
+    }
+
+    constexpr auto operator+=(difference_type n) -> Iterator_t&
+    {
+      mPos += n;
+      return *this;
+    }
+
+    constexpr auto operator-=(difference_type n) -> Iterator_t&
+    {
+      mPos -= n;
+      return *this;
+    }
+
+    friend constexpr auto operator+(Iterator_t it, difference_type n) -> Iterator_t { return it += n; }
+    friend constexpr auto operator+(difference_type n, Iterator_t it) -> Iterator_t { return it += n; }
+    friend constexpr auto operator-(Iterator_t it, difference_type n) -> Iterator_t { return it -= n; }
+    friend constexpr auto operator-(Iterator_t lhs, Iterator_t rhs) -> difference_type
+    {
+      return static_cast<difference_type>(lhs.mPos) - static_cast<difference_type>(rhs.mPos);
+    }
+    friend constexpr auto operator==(Iterator_t lhs, Iterator_t rhs) -> bool { return lhs.mPos == rhs.mPos; }
+    friend constexpr auto operator<=>(Iterator_t lhs, Iterator_t rhs) { return lhs.mPos <=> rhs.mPos; }
+
+  private:
+    Pages_t   mPages{};
+    size_type mPos{};
+  };
+
+  using iterator               = Iterator_t<false>;
+  using const_iterator         = Iterator_t<true>;
+  using reverse_iterator       = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  constexpr explicit PagedVector_t(const Alloc_t& alloc = Alloc_t{})
+    : mAlloc{ alloc }
+    , mPages{ PagesAlloc_t{ alloc } }
+  {
+  }
+
+  constexpr PagedVector_t(PagedVector_t&& other) noexcept
+    : mAlloc{ other.mAlloc }
+    , mPages{ std::move(other.mPages) }
+    , mSize{ std::exchange(other.mSize, 0) }
+  {
+  }
+
+  // the allocators are expected to be equal, as it happens with std::vector
+  // when they do not propagate
+  constexpr auto operator=(PagedVector_t&& other) noexcept -> PagedVector_t&
+  {
+    Release();
+    mPages = std::move(other.mPages);
+    mSize  = std::exchange(other.mSize, 0);
+
+    return *this;
+  }
+
+  PagedVector_t(const PagedVector_t&)                    = delete;
+  auto operator=(const PagedVector_t&) -> PagedVector_t& = delete;
+
+  ~PagedVector_t() { Release(); }
+
+  template<class... Args_t> constexpr auto emplace_back(Args_t&&... args) -> reference
+  {
+    if (mSize == capacity()) {
+      mPages.emplace_back(AllocatePage());
+    }
+    auto* value{ std::construct_at(std::addressof((*this)[mSize]), std::forward<Args_t>(args)...) };
+    ++mSize;
+    return *value;
+  }
+
+  constexpr auto pop_back() -> void { std::destroy_at(std::addressof((*this)[--mSize])); }
+
+  constexpr auto clear() -> void
+  {
+    while (mSize != 0) {
+      pop_back();
+    }
+  }
+
+  constexpr auto reserve(size_type new_cap) -> void
+  {
+    while (capacity() < new_cap) {
+      mPages.emplace_back(AllocatePage());
+    }
+  }
+
+  constexpr auto resize(size_type count) -> void
+  {
+    reserve(count);
+    while (mSize < count) {
+      emplace_back();
+    }
+    while (mSize > count) {
+      pop_back();
+    }
+  }
+
+  constexpr auto shrink_to_fit() -> void
+  {
+    while (capacity() - mSize >= page_size) {
+      DeallocatePage(mPages.back());
+      mPages.pop_back();
+    }
+  }
+
+  constexpr auto size() const -> size_type { return mSize; }
+
+  [[nodiscard]] constexpr auto empty() const -> bool { return mSize == 0; }
+
+  constexpr auto capacity() const -> size_type { return mPages.size() * page_size; }
+
+  // number of elements stored contiguously starting at pos
+  constexpr auto contiguous_size(size_type pos) const -> size_type
+  {
+    return std::min(page_size - pos % page_size, mSize - pos);
+  }
+
+  constexpr auto operator[](size_type pos) -> reference { return mPages[pos / page_size][pos % page_size]; }
+
+  constexpr auto operator[](size_type pos) const -> const_reference { return mPages[pos / page_size][pos % page_size]; }
+
+  constexpr auto back() -> reference { return (*this)[mSize - 1]; }
+
+  constexpr auto back() const -> const_reference { return (*this)[mSize - 1]; }
+
+  constexpr auto begin() -> iterator { return { mPages.data(), 0 }; }
+
+  constexpr auto begin() const -> const_iterator { return { mPages.data(), 0 }; }
+
+  constexpr auto cbegin() const -> const_iterator { return begin(); }
+
+  constexpr auto end() -> iterator { return { mPages.data(), mSize }; }
+
+  constexpr auto end() const -> const_iterator { return { mPages.data(), mSize }; }
+
+  constexpr auto cend() const -> const_iterator { return end(); }
+
+  constexpr auto rbegin() -> reverse_iterator { return reverse_iterator{ end() }; }
+
+  constexpr auto rbegin() const -> const_reverse_iterator { return const_reverse_iterator{ end() }; }
+
+  constexpr auto crbegin() const -> const_reverse_iterator { return rbegin(); }
+
+  constexpr auto rend() -> reverse_iterator { return reverse_iterator{ begin() }; }
+
+  constexpr auto rend() const -> const_reverse_iterator { return const_reverse_iterator{ begin() }; }
+
+  constexpr auto crend() const -> const_reverse_iterator { return rend(); }
+
+private:
+  using AllocTraits_t = std::allocator_traits<Alloc_t>;
+  using PagesAlloc_t  = typename AllocTraits_t::template rebind_alloc<T*>;
+
+  constexpr auto AllocatePage() -> T* { return std::to_address(AllocTraits_t::allocate(mAlloc, page_size)); }
+
+  constexpr auto DeallocatePage(T* page) -> void { AllocTraits_t::deallocate(mAlloc, page, page_size); }
+
+  constexpr auto Release() -> void
+  {
+    clear();
+    for (auto* page : mPages) {
+      DeallocatePage(page);
+    }
+    mPages.clear();
+  }
+
+  Alloc_t                       mAlloc{};
+  std::vector<T*, PagesAlloc_t> mPages{};
+  size_type                     mSize{};
+};
+
+} // namespace ECS
@@ -0,0 +1,235 @@
+#pragma once
+
+#include "ecs_map.hpp"
+#include "job_system.hpp"
+#include "traits.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace ECS {
+
+template<class... Ts> struct Read_t
+{
+  using type = TMPL::TypeList_t<Ts...>;
+};
+
+template<class... Ts> struct Write_t
+{
+  using type = TMPL::TypeList_t<Ts...>;
+};
+
+// A ForEach<Sign_t> callback plus the components it accesses. The components
+// of Sign_t the callback takes as T& are written, the others are read and
+// handed out const: taken as const T&, by value or through a generic
+// parameter. When the callback takes no component, or the handle of a world
+// with another Config_t::Index_t, the components not in Reads_t count as
+// written. Components reached through GetComponent must be declared.
+// The world is traversed const, so only the written components of tracked
+// types are recorded as changed.
+template<class Sign_t, class Reads_t, class Writes_t, class Fn_t> struct System_t
+{
+  using signature_type = Sign_t;
+
+  // ForEach passes the components alone only when there are several
+  template<class... Args_t>
+  static constexpr bool TakesComponents_v{ std::is_invocable_v<Fn_t&, Args_t..., Handle_t<Sign_t>> ||
+                                           (sizeof...(Args_t) > 1 && std::is_invocable_v<Fn_t&, Args_t...>) };
+
+  // component T as probed: const for Cmp_t and the tags, mutable otherwise
+  template<class Cmp_t, class T>
+  using Probe_t = std::conditional_t<std::is_same_v<Cmp_t, T> || Traits::IsTag_v<T>, const T&, T&>;
+
+  template<class Cmp_t> struct IsParamWrite
+  {
+    static constexpr auto value{ Seq::Unpacker_t<Traits::Components_t<Sign_t>>::Call([]<class... Ts_t>() {
+      if constexpr (Traits::IsTag_v<Cmp_t>) {
+        return false;
+      } else if constexpr (TakesComponents_v<Probe_t<void, Ts_t>...>) {
+        return !TakesComponents_v<Probe_t<Cmp_t, Ts_t>...>;
+      } else {
+        return !std::is_invocable_v<Fn_t&, Handle_t<Sign_t>> && !Seq::Contains_v<Cmp_t, typename Reads_t::type>;
+      }
+    }) };
+  };
+
+  using writes_type = Seq::MakeSet_t<
+    Seq::Cat_t<typename Writes_t::type, Seq::Filter_t<Traits::Components_t<Sign_t>, IsParamWrite>>>;
+  using reads_type =
+    Seq::MakeSet_t<Seq::Cat_t<typename Reads_t::type, Seq::Difference_t<Traits::Components_t<Sign_t>, writes_type>>>;
+  using access_type = Seq::MakeSet_t<Seq::Cat_t<reads_type, writes_type>>;
+
+  template<class Cmp_t>
+  using Param_t =
+    std::conditional_t<Seq::Contains_v<Cmp_t, writes_type> && !Traits::IsTag_v<Cmp_t>, Cmp_t&, const Cmp_t&>;
+
+  constexpr auto operator()(auto& ecs_man) -> void
+  {
+    using ECSMan_t = std::remove_reference_t<decltype(ecs_man)>;
+    static_assert(!std::is_const_v<ECSMan_t> || Seq::Size_v<writes_type> == 0,
+                  "A system writing components needs a mutable world");
+    using Visit_t = Seq::As_t<Visitor_t, Seq::Cat_t<TMPL::TypeList_t<ECSMan_t>, Traits::Components_t<Sign_t>>>;
+    std::as_const(ecs_man).template ForEach<Sign_t>(Visit_t{ mFn, ecs_man });
+  }
+
+  Fn_t        mFn;
+  const char* mName{};
+
+private:
+  // callback of the const traversal, it hands out the written components
+  // mutable, through the world when their changes are tracked
+  template<class ECSMan_t, class... Cmps_t> struct Visitor_t
+  {
+    constexpr auto operator()(const Cmps_t&... cmps, auto handle) const -> void
+    {
+      if constexpr (std::is_invocable_v<Fn_t&, Param_t<Cmps_t>..., decltype(handle)>) {
+        mFn(Access(cmps, handle)..., handle);
+      } else if constexpr (sizeof...(Cmps_t) > 1 && std::is_invocable_v<Fn_t&, Param_t<Cmps_t>...>) {
+        mFn(Access(cmps, handle)...);
+      } else {
+        static_assert(std::is_invocable_v<Fn_t&, decltype(handle)>,
+                      "The callback takes the components of the signature or its handle");
+        mFn(handle);
+      }
+    }
+
+    // the values of untracked types are not const, the traversal only is
+    template<class Cmp_t> constexpr auto Access(const Cmp_t& cmp, auto handle) const -> Param_t<Cmp_t>
+    {
+      if constexpr (std::is_const_v<std::remove_reference_t<Param_t<Cmp_t>>>) {
+        return cmp;
+      } else if constexpr (TracksChanges_v<Cmp_t>) {
+        return mECSMan.template GetComponent<Cmp_t>(handle);
+      } else {
+        return const_cast<Cmp_t&>(cmp);
+      }
+    }
+
+    Fn_t&     mFn;
+    ECSMan_t& mECSMan;
+  };
+};
+
+template<class Sign_t, class Reads_t = Read_t<>, class Writes_t = Write_t<>, class Fn_t>
+constexpr auto
+MakeSystem(Fn_t fn, const char* name = "") -> System_t<Sign_t, Reads_t, Writes_t, Fn_t>
+{
+  return { std::move(fn), name };
+}
+
+// Orders the systems in waves at compile time. A system goes in the wave after
+// the last earlier system it conflicts with, two systems conflict when one
+// writes a component the other accesses. The systems of a wave run
+// concurrently on a JobSystem_t and the waves run one after another, so
+// conflicting systems keep their registration order.
+// Structural changes must go through a CommandBuffer_t per worker.
+template<class... Systems_t> struct Scheduler_t
+{
+  static constexpr std::size_t size{ sizeof...(Systems_t) };
+
+  constexpr explicit Scheduler_t(Systems_t... systems)
+    : mSystems{ std::move(systems)... }
+  {
+  }
+
+  template<class Sys1_t, class Sys2_t>
+  static constexpr bool Conflict_v{
+    Seq::Size_v<Seq::Difference_t<typename Sys1_t::writes_type, typename Sys2_t::access_type>> !=
+      Seq::Size_v<typename Sys1_t::writes_type> ||
+    Seq::Size_v<Seq::Difference_t<typename Sys2_t::writes_type, typename Sys1_t::access_type>> !=
+      Seq::Size_v<typename Sys2_t::writes_type>
+  };
+
+  template<class Sys_t> static constexpr std::array<bool, size> ConflictRow_v{ Conflict_v<Sys_t, Systems_t>... };
+
+  static constexpr std::array<std::array<bool, size>, size> conflicts{ ConflictRow_v<Systems_t>... };
+
+  static constexpr auto waves{ [] {
+    std::array<std::size_t, size> waves{};
+    for (std::size_t j{}; j < size; ++j) {
+      for (std::size_t i{}; i < j; ++i) {
+        if (conflicts[j][i]) {
+          waves[j] = std::max(waves[j], waves[i] + 1);
+        }
+      }
+    }
+    return waves;
+  }() };
+
+  static constexpr std::size_t wave_count{ size == 0 ? 0 : *std::max_element(waves.begin(), waves.end()) + 1 };
+
+  // system indices sorted by wave
+  static constexpr auto order{ [] {
+    std::array<std::size_t, size> order{};
+    std::size_t                   n{};
+    for (std::size_t wave{}; wave < wave_count; ++wave) {
+      for (std::size_t i{}; i < size; ++i) {
+        if (waves[i] == wave) {
+          order[n++] = i;
+        }
+      }
+    }
+    return order;
+  }() };
+
+  constexpr auto Run(auto& ecs_man, JobSystem_t& jobs = JobSystem_t::Default()) -> void
+  {
+    std::size_t first{};
+    for (std::size_t wave{}; wave < wave_count; ++wave) {
+      auto last{ first };
+      while (last < size && waves[order[last]] == wave) {
+        ++last;
+      }
+      jobs.ParallelFor(last - first, 1, [&](std::size_t begin, std::size_t end) {
+        for (auto i{ begin }; i < end; ++i) {
+          RunSystem(order[first + i], ecs_man, std::make_index_sequence<size>{});
+        }
+      });
+      first = last;
+    }
+  }
+
+  // one line per system grouped by wave, with the earlier systems it waits for
+  auto Dump() const -> std::string
+  {
+    std::string out{};
+    for (std::size_t i{}; i < size; ++i) {
+      auto sys{ order[i] };
+      if (i == 0 || waves[order[i - 1]] != waves[sys]) {
+        out += "wave " + std::to_string(waves[sys]) + "\n";
+      }
+      std::string deps{};
+      for (std::size_t dep{}; dep < sys; ++dep) {
+        if (conflicts[sys][dep]) {
+          deps += (deps.empty() ? "#" : ", #") + std::to_string(dep);
+        }
+      }
+      out += "  #" + std::to_string(sys) + " " + GetName(sys, std::make_index_sequence<size>{});
+      out += deps.empty() ? "\n" : " (after " + deps + ")\n";
+    }
+    return out;
+  }
+
+private:
+  template<std::size_t... Is>
+  constexpr auto RunSystem(std::size_t sys, auto& ecs_man, std::index_sequence<Is...>) -> void
+  {
+    ((sys == Is ? std::get<Is>(mSystems)(ecs_man) : void()), ...);
+  }
+
+  template<std::size_t... Is> auto GetName(std::size_t sys, std::index_sequence<Is...>) const -> std::string
+  {
+    const char* name{};
+    ((name = sys == Is ? std::get<Is>(mSystems).mName : name), ...);
+    return name;
+  }
+
+  std::tuple<Systems_t...> mSystems;
+};
+
+} // namespace ECS
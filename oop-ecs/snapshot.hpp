@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ECS {
+
+// Arrays start at multiples of this offset, so a snapshot mapped at a page
+// boundary can back them in place, see ImageReader_t.
+inline constexpr std::size_t snapshot_alignment{ 64 };
+
+// Bytes of a world snapshot. Values are written in the byte order of the
+// machine, the snapshot layout hash records it.
+struct SnapshotWriter_t
+{
+  constexpr auto WriteBytes(const void* data, std::size_t size) -> void
+  {
+    const auto* bytes{ static_cast<const std::byte*>(data) };
+    mBytes.insert(mBytes.end(), bytes, bytes + size);
+  }
+
+  template<class T> constexpr auto Write(const T& value) -> void
+  {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values are written as bytes");
+    WriteBytes(std::addressof(value), sizeof(T));
+  }
+
+  // pads with zeros up to the next multiple of snapshot_alignment
+  constexpr auto Align() -> void
+  {
+    mBytes.resize((mBytes.size() + snapshot_alignment - 1) / snapshot_alignment * snapshot_alignment);
+  }
+
+  // the size followed by the aligned elements of a contiguous container
+  template<class Container_t> constexpr auto WriteArray(const Container_t& values) -> void
+  {
+    Write(static_cast<std::uint64_t>(values.size()));
+    Align();
+    WriteBytes(values.data(), values.size() * sizeof(typename Container_t::value_type));
+  }
+
+  constexpr auto Reserve(std::size_t size) -> void { mBytes.reserve(size); }
+
+  constexpr auto GetBytes() const -> std::span<const std::byte> { return mBytes; }
+
+  constexpr auto Release() -> std::vector<std::byte> { return std::exchange(mBytes, {}); }
+
+private:
+  std::vector<std::byte> mBytes{};
+};
+
+// Reads a snapshot from bytes it does not own. Reading past the end fails
+// the reader, from then on every read fails and yields zeroed values.
+struct SnapshotReader_t
+{
+  constexpr explicit SnapshotReader_t(std::span<const std::byte> bytes)
+    : mBytes{ bytes }
+  {
+  }
+
+  constexpr auto ReadBytes(void* data, std::size_t size) -> bool
+  {
+    if (size == 0) {
+      return !mFailed;
+    }
+    if (mFailed || size > Remaining()) {
+      Fail();
+      std::memset(data, 0, size);
+      return false;
+    }
+    std::memcpy(data, mBytes.data() + mOffset, size);
+    mOffset += size;
+    return true;
+  }
+
+  template<class T> constexpr auto Read() -> T
+  {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values are read as bytes");
+    T value{};
+    ReadBytes(std::addressof(value), sizeof(T));
+    return value;
+  }
+
+  constexpr auto Align() -> void
+  {
+    auto offset{ (mOffset + snapshot_alignment - 1) / snapshot_alignment * snapshot_alignment };
+    if (offset > mBytes.size()) {
+      Fail();
+    } else {
+      mOffset = offset;
+    }
+  }
+
+  // replaces the elements of a resizable contiguous container
+  template<class Container_t> constexpr auto ReadArray(Container_t& values) -> bool
+  {
+    using value_type = typename Container_t::value_type;
+    auto size{ Read<std::uint64_t>() };
+    Align();
+    if (size > Remaining() / sizeof(value_type)) {
+      Fail();
+    }
+    values.resize(mFailed ? 0 : static_cast<std::size_t>(size));
+    return ReadBytes(values.data(), values.size() * sizeof(value_type));
+  }
+
+  constexpr auto Fail() -> void { mFailed = true; }
+
+  constexpr auto Failed() const -> bool { return mFailed; }
+
+  constexpr auto Remaining() const -> std::size_t { return mBytes.size() - mOffset; }
+
+protected:
+  std::span<const std::byte> mBytes{};
+  std::size_t                mOffset{};
+  bool                       mFailed{};
+};
+
+// Reader of a world image, a snapshot whose arrays are used in place by the
+// containers able to borrow them. The bytes must start at a multiple of
+// snapshot_alignment, stay valid as long as the world uses them, and be
+// writable, like a MAP_PRIVATE mapping whose pages are copied on write.
+struct ImageReader_t : SnapshotReader_t
+{
+  constexpr explicit ImageReader_t(std::span<std::byte> image)
+    : SnapshotReader_t{ image }
+  {
+  }
+
+  // the next count aligned values of T, empty once failed
+  template<class T> constexpr auto Borrow(std::size_t count) -> std::span<T>
+  {
+    static_assert(alignof(T) <= snapshot_alignment, "The values are over-aligned for a world image");
+    Align();
+    if (mFailed || count > Remaining() / sizeof(T)) {
+      Fail();
+      return {};
+    }
+    // the bytes were handed over writable
+    auto* values{ reinterpret_cast<T*>(const_cast<std::byte*>(mBytes.data() + mOffset)) };
+    mOffset += count * sizeof(T);
+    return { values, count };
+  }
+
+  // the values of an array written by WriteArray
+  template<class T> constexpr auto BorrowArray() -> std::span<T>
+  {
+    auto size{ Read<std::uint64_t>() };
+    return Borrow<T>(mFailed ? 0 : static_cast<std::size_t>(std::min<std::uint64_t>(size, Remaining())));
+  }
+};
+
+// Values that are not written as raw bytes need a codec, a specialization of
+// SnapshotCodec with
+//   static auto Write(ECS::SnapshotWriter_t& out, const T& value) -> void;
+//   static auto Read(ECS::SnapshotReader_t& in) -> T;
+// Read must not trust the bytes, the reader fails on truncated input.
+template<class T> struct SnapshotCodec
+{};
+
+template<class T>
+concept HasSnapshotCodec = requires(SnapshotWriter_t& out, SnapshotReader_t& in, const T& value) {
+  SnapshotCodec<T>::Write(out, value);
+  { SnapshotCodec<T>::Read(in) } -> std::same_as<T>;
+};
+
+// Values copied as raw bytes, a whole column at once, and used in place from
+// a world image. Trivially copyable types are, a type whose bytes are all its
+// state can opt in by specializing SnapshotBlob.
+template<class T>
+struct SnapshotBlob
+  : std::bool_constant<std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>>
+{};
+
+template<class T> constexpr bool IsSnapshotBlob_v{ SnapshotBlob<T>::value && !HasSnapshotCodec<T> };
+
+// FNV-1a step, used to fingerprint the layout of what a snapshot holds
+constexpr auto
+SnapshotHash(std::uint64_t hash, std::uint64_t value) -> std::uint64_t
+{
+  for (auto i{ 0 }; i < 8; ++i) {
+    hash = (hash ^ ((value >> (i * 8)) & 0xff)) * 0x100000001b3;
+  }
+  return hash;
+}
+
+template<class T> constexpr auto SnapshotLayout(std::uint64_t hash) -> std::uint64_t
+{
+  hash = SnapshotHash(hash, sizeof(T));
+  hash = SnapshotHash(hash, alignof(T));
+  return SnapshotHash(hash, IsSnapshotBlob_v<T>);
+}
+
+} // namespace ECS
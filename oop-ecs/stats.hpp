@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+namespace ECS {
+
+// Memory of one container, entity rows or component values. The bytes used
+// are those of the live values and of the key, index and version entries
+// that map them, the rest of the bytes held is spare capacity and entries of
+// the free keys.
+struct ContainerStats_t
+{
+  std::string_view mName{};
+  std::size_t      mSize{};
+  std::size_t      mCapacity{};
+  std::size_t      mFreeSlots{};
+  std::size_t      mUsedBytes{};
+  std::size_t      mAllocatedBytes{};
+
+  constexpr auto WastedBytes() const -> std::size_t { return mAllocatedBytes - mUsedBytes; }
+
+  // fraction of the capacity holding live values
+  constexpr auto Occupancy() const -> double
+  {
+    return mCapacity == 0 ? 1 : static_cast<double>(mSize) / static_cast<double>(mCapacity);
+  }
+};
+
+template<class Map_t>
+constexpr auto
+MakeContainerStats(std::string_view name, const Map_t& map) -> ContainerStats_t
+{
+  return { name, map.size(), map.capacity(), map.free_count(), map.used_bytes(), map.allocated_bytes() };
+}
+
+// mSize counts the entities of the signature and of its instances, mRows only
+// the rows of the signature. mDisorder estimates ECSManager_t::Disorder from
+// a sample of the rows.
+struct SignatureStats_t
+{
+  std::string_view mName{};
+  std::size_t      mSize{};
+  ContainerStats_t mRows{};
+  double           mDisorder{};
+};
+
+// Stats of a world, see ECSManager_t::Stats. The components are in the
+// order of the component containers, one per component type with shared
+// storage and one per column with archetype storage.
+template<std::size_t Components, std::size_t Signatures> struct WorldStats_t
+{
+  std::array<ContainerStats_t, Components> mComponents{};
+  std::array<SignatureStats_t, Signatures> mSignatures{};
+
+  constexpr auto UsedBytes() const -> std::size_t
+  {
+    return Sum([](const ContainerStats_t& stats) { return stats.mUsedBytes; });
+  }
+
+  constexpr auto AllocatedBytes() const -> std::size_t
+  {
+    return Sum([](const ContainerStats_t& stats) { return stats.mAllocatedBytes; });
+  }
+
+private:
+  constexpr auto Sum(auto get) const -> std::size_t
+  {
+    std::size_t total{};
+    for (const auto& stats : mComponents) {
+      total += get(stats);
+    }
+    for (const auto& stats : mSignatures) {
+      total += get(stats.mRows);
+    }
+    return total;
+  }
+};
+
+} // namespace ECS
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "ecs_map.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace ECS {
+
+// Every component type lives in one ECSMap_t shared by all the signatures.
+struct SharedStorage_t
+{};
+
+// Every signature owns one column per component, plus a column with the
+// handle of the entity owning each row. The columns of a signature are always
+// created and erased together, so the same position in each of them belongs to
+// the same entity and they can be streamed in lockstep.
+struct ArchetypeStorage_t
+{};
+
+// Every entity has a row in the entity map of its signature plus one in the
+// map of each of its bases, so the handle of a base addresses a row of its
+// own. The base rows are created, moved and destroyed with the entity.
+struct MaterializedBases_t
+{};
+
+// Only the signature an entity is created with has a row. The entities of a
+// base are found through the rows of the signatures deriving from it, and
+// every handle packs the signature of the entity with its row like
+// ParentID_t, so the handles of all the signatures of an entity hold the same
+// value.
+struct VirtualBases_t
+{};
+
+template<class Sign_t, class T> struct Column_t
+{
+  using signature_type = Sign_t;
+  using value_type     = T;
+};
+
+// value type of a column of either storage
+template<class Col_t> struct ColumnValue : std::type_identity<Col_t>
+{};
+
+template<class Sign_t, class T> struct ColumnValue<Column_t<Sign_t, T>> : std::type_identity<T>
+{};
+
+template<class Col_t> using ColumnValue_t = typename ColumnValue<Col_t>::type;
+
+template<class Col_t, class Alloc_t = std::allocator<typename Col_t::value_type>, class Index_t = std::size_t>
+struct ColumnMap_t : ECSMap_t<typename Col_t::value_type, Alloc_t, Index_t>
+{
+  constexpr explicit ColumnMap_t(const Alloc_t& alloc = Alloc_t{})
+    : ECSMap_t<typename Col_t::value_type, Alloc_t, Index_t>{ alloc }
+  {
+  }
+};
+
+} // namespace ECS
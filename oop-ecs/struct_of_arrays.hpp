@@ -25,6 +25,13 @@ public:
     CheckIfTypesAreUnique();
   }
 
+  template<class Alloc_t>
+  constexpr explicit SoA_t(const Alloc_t& alloc)
+    : Container_t<Ts>{ alloc }...
+  {
+    CheckIfTypesAreUnique();
+  }
+
   template<class T, class U> constexpr auto operator[](U u) -> auto& { return GetRequiredContainer<T>()[u]; }
 
   template<class T, class U> constexpr auto operator[](U u) const -> const auto&
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "helpers.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace ECS {
+
+// Work done by one call of the manager, times in nanoseconds since the
+// recorder started. The name and the signature are static strings.
+struct TraceEvent_t
+{
+  const char*      mName{};
+  std::string_view mSignature{};
+  std::uint64_t    mStart{};
+  std::uint64_t    mDuration{};
+  std::uint64_t    mCount{};
+};
+
+// Default Config_t::Tracer_t, its scopes are empty and record nothing.
+struct NoTracer_t
+{
+  struct Scope_t
+  {
+    constexpr Scope_t(const char*, std::string_view, std::size_t) {}
+  };
+};
+
+// Tracer recording the scopes of each thread in a ring of its own. Only that
+// thread writes the ring and publishes its head with a release store, so
+// recording takes no lock, and a full ring overwrites its oldest events. A
+// thread registers its ring under a lock the first time it records.
+// The events are read while no thread records, between frames for instance,
+// an event written during the read can be torn.
+struct TraceRecorder_t final : Uncopyable_t
+{
+  static constexpr std::size_t ring_size{ 16384 };
+
+  struct Scope_t final : Uncopyable_t
+  {
+    Scope_t(const char* name, std::string_view signature, std::size_t count)
+      : mEvent{ name, signature, Default().Now(), 0, count }
+    {
+    }
+
+    ~Scope_t()
+    {
+      auto& recorder{ Default() };
+      mEvent.mDuration = recorder.Now() - mEvent.mStart;
+      recorder.Record(mEvent);
+    }
+
+  private:
+    TraceEvent_t mEvent{};
+  };
+
+  // the recorder of the process, the rings of the threads are its own
+  static auto Default() -> TraceRecorder_t&
+  {
+    static TraceRecorder_t recorder{};
+    return recorder;
+  }
+
+  auto Now() const -> std::uint64_t
+  {
+    return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mEpoch).count());
+  }
+
+  auto Record(const TraceEvent_t& event) -> void
+  {
+    auto& ring{ GetRing() };
+    auto  head{ ring.mHead.load(std::memory_order_relaxed) };
+    ring.mEvents[head % ring_size] = event;
+    ring.mHead.store(head + 1, std::memory_order_release);
+  }
+
+  // calls fn(thread, event) with the events kept, oldest first per thread,
+  // the threads numbered from 1 in the order they started recording
+  auto Visit(auto fn) const -> void
+  {
+    std::lock_guard lock{ mMutex };
+    for (const auto& ring : mRings) {
+      auto head{ ring->mHead.load(std::memory_order_acquire) };
+      auto kept{ std::min<std::uint64_t>(head, ring_size) };
+      auto first{ std::max(ring->mTail.load(std::memory_order_relaxed), head - kept) };
+      for (; first < head; ++first) {
+        fn(ring->mThread, ring->mEvents[first % ring_size]);
+      }
+    }
+  }
+
+  // forgets the events recorded so far
+  auto Clear() -> void
+  {
+    std::lock_guard lock{ mMutex };
+    for (auto& ring : mRings) {
+      ring->mTail.store(ring->mHead.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+  }
+
+  // Chrome trace event format, opened by Perfetto and chrome://tracing
+  auto WriteChromeTrace(std::FILE* file) const -> bool
+  {
+    auto separator{ "" };
+    std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", file);
+    Visit([&](std::uint64_t thread, const TraceEvent_t& event) {
+      std::fprintf(file,
+                   "%s\n{\"name\":\"%s\",\"cat\":\"ecs\",\"ph\":\"X\",\"pid\":1,\"tid\":%llu,\"ts\":%.3f,\"dur\":%.3f,"
+                   "\"args\":{\"signature\":\"%.*s\",\"entities\":%llu}}",
+                   separator,
+                   event.mName,
+                   static_cast<unsigned long long>(thread),
+                   static_cast<double>(event.mStart) / 1e3,
+                   static_cast<double>(event.mDuration) / 1e3,
+                   static_cast<int>(event.mSignature.size()),
+                   event.mSignature.data(),
+                   static_cast<unsigned long long>(event.mCount));
+      separator = ",";
+    });
+    return std::fputs("\n]}\n", file) >= 0;
+  }
+
+  auto WriteChromeTrace(const char* path) const -> bool
+  {
+    auto* file{ std::fopen(path, "w") };
+    if (file == nullptr) {
+      return false;
+    }
+    auto written{ WriteChromeTrace(file) };
+    return std::fclose(file) == 0 && written;
+  }
+
+private:
+  // one cache line apart so the heads of the threads do not share lines
+  struct alignas(64) Ring_t
+  {
+    std::atomic<std::uint64_t>          mHead{};
+    std::atomic<std::uint64_t>          mTail{};
+    std::uint64_t                       mThread{};
+    std::array<TraceEvent_t, ring_size> mEvents{};
+  };
+
+  TraceRecorder_t() = default;
+
+  auto GetRing() -> Ring_t&
+  {
+    if (sRing == nullptr) {
+      std::lock_guard lock{ mMutex };
+      sRing          = mRings.emplace_back(std::make_unique<Ring_t>()).get();
+      sRing->mThread = mRings.size();
+    }
+    return *sRing;
+  }
+
+  static inline thread_local Ring_t* sRing{};
+
+  std::chrono::steady_clock::time_point mEpoch{ std::chrono::steady_clock::now() };
+  mutable std::mutex                    mMutex{};
+  std::vector<std::unique_ptr<Ring_t>>  mRings{};
+};
+
+} // namespace ECS
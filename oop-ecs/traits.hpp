@@ -3,15 +3,20 @@
 #include <tmpl/sequence.hpp>
 #include <tmpl/type_list.hpp>
 
+#include <cstddef>
+#include <memory>
 #include <type_traits>
 
+#include "class.hpp"
+#include "storage.hpp"
+#include "trace.hpp"
 #include "type_aliases.hpp"
 
 namespace ECS {
 
 namespace Seq = TMPL::Sequence;
 
-template<class T> struct Handle_t;
+template<class T, class Index_t> struct Handle_t;
 
 namespace Traits {
 
@@ -79,9 +84,27 @@ template<class... Ts> struct Components
 
 template<class... Ts> using Components_t = typename Components<Ts...>::type;
 
+// Empty components are tags: every entity of a signature listing one has it,
+// so they get no storage and no handle.
+template<class T> struct IsTag : std::is_empty<T>
+{};
+
+template<class T> static inline constexpr auto IsTag_v{ IsTag<T>::value };
+
+template<class T> using IsStored = std::bool_constant<!IsTag_v<T>>;
+
+template<class... Ts> using StoredComponents_t = Seq::Filter_t<Components_t<Ts...>, IsStored>;
+
+template<class... Ts> using Tags_t = Seq::Filter_t<Components_t<Ts...>, IsTag>;
+
+// the only instance handed out for every tag of type T, read-only since it is
+// shared by every entity and every thread
+template<class T> inline const T TagInstance{};
+
 template<class Fn_t, class... Args_t> struct IsInvocable;
 
-template<class Fn_t, class Sig_t> struct IsInvocable<Fn_t, Handle_t<Sig_t>> : std::is_invocable<Fn_t, Handle_t<Sig_t>>
+template<class Fn_t, class Sig_t, class Index_t>
+struct IsInvocable<Fn_t, Handle_t<Sig_t, Index_t>> : std::is_invocable<Fn_t, Handle_t<Sig_t, Index_t>>
 {};
 
 template<class Fn_t, template<class...> class Sig_t, class... Sigs_t, class EntIdx_t>
@@ -125,6 +148,103 @@ struct IsInstanceOf
 template<class Sign1_t, class Sign2_t>
 static inline constexpr auto IsInstanceOf_v{ IsInstanceOf<Sign1_t, Sign2_t>::value };
 
+template<class T> struct Excluded : std::type_identity<TMPL::TypeList_t<>>
+{
+  static constexpr auto IsFilter_v{ false };
+};
+
+template<class... Ts> struct Excluded<Without_t<Ts...>> : std::type_identity<TMPL::TypeList_t<Ts...>>
+{
+  static constexpr auto IsFilter_v{ true };
+};
+
+template<class T> using IsRequired = std::bool_constant<!Excluded<T>::IsFilter_v>;
+
+// Query of ECSManager_t::ForEachWith: the components Ts other than the
+// Without_t filters, and the signatures of Signs_t having all of them and
+// none of the filtered ones.
+template<class Signs_t, class... Ts> struct Query
+{
+  using Required_t = Seq::Filter_t<TMPL::TypeList_t<Ts...>, IsRequired>;
+  using Excluded_t = Seq::Cat_t<TMPL::TypeList_t<>, typename Excluded<Ts>::type...>;
+
+  template<class Sign_t>
+  using IsMatch = std::bool_constant<Seq::IsSubsetOf_v<Required_t, Components_t<Sign_t>> &&
+                                     Seq::Size_v<Seq::Difference_t<Excluded_t, Components_t<Sign_t>>> ==
+                                       Seq::Size_v<Excluded_t>>;
+
+  using Signatures_t = Seq::Filter_t<Signs_t, IsMatch>;
+};
+
+template<class Config_t, class = void> struct Storage : std::type_identity<SharedStorage_t>
+{};
+
+template<class Config_t>
+struct Storage<Config_t, std::void_t<typename Config_t::Storage_t>> : std::type_identity<typename Config_t::Storage_t>
+{};
+
+template<class Config_t> using Storage_t = typename Storage<Config_t>::type;
+
+template<class Config_t>
+static inline constexpr auto IsArchetypeStorage_v{ std::is_same_v<Storage_t<Config_t>, ArchetypeStorage_t> };
+
+template<class Config_t, class = void> struct BaseStorage : std::type_identity<MaterializedBases_t>
+{};
+
+template<class Config_t>
+struct BaseStorage<Config_t, std::void_t<typename Config_t::BaseStorage_t>>
+  : std::type_identity<typename Config_t::BaseStorage_t>
+{};
+
+template<class Config_t> using BaseStorage_t = typename BaseStorage<Config_t>::type;
+
+template<class Config_t>
+static inline constexpr auto IsVirtualBases_v{ std::is_same_v<BaseStorage_t<Config_t>, VirtualBases_t> };
+
+template<class Config_t, class = void> struct OptionalTags : std::type_identity<TMPL::TypeList_t<>>
+{};
+
+template<class Config_t>
+struct OptionalTags<Config_t, std::void_t<typename Config_t::OptionalTags_t>>
+  : std::type_identity<typename Config_t::OptionalTags_t>
+{};
+
+template<class Config_t> using OptionalTags_t = typename OptionalTags<Config_t>::type;
+
+template<class Config_t, class T, class = void> struct Allocator : std::type_identity<std::allocator<T>>
+{};
+
+template<class Config_t, class T>
+struct Allocator<Config_t, T, std::void_t<typename Config_t::template Allocator_t<T>>>
+  : std::type_identity<typename Config_t::template Allocator_t<T>>
+{};
+
+template<class Config_t, class T> using Allocator_t = typename Allocator<Config_t, T>::type;
+
+// Config_t::Index_t, std::size_t by default, is the integer of the keys and
+// handles of every map. With materialized bases a row links its concrete
+// entity by a word holding the signature index in its high bits, so each
+// signature holds at most ParentID_t::row_mask entities: max() >> bit_width
+// of the signature count minus one, 8191 with std::uint16_t and 5 signatures.
+// The limit is only checked in debug builds and when a snapshot is loaded.
+template<class Config_t, class = void> struct Index : std::type_identity<std::size_t>
+{};
+
+template<class Config_t> struct Index<Config_t, std::void_t<typename Config_t::Index_t>>
+  : std::type_identity<typename Config_t::Index_t>
+{};
+
+template<class Config_t> using Index_t = typename Index<Config_t>::type;
+
+template<class Config_t, class = void> struct Tracer : std::type_identity<NoTracer_t>
+{};
+
+template<class Config_t> struct Tracer<Config_t, std::void_t<typename Config_t::Tracer_t>>
+  : std::type_identity<typename Config_t::Tracer_t>
+{};
+
+template<class Config_t> using Tracer_t = typename Tracer<Config_t>::type;
+
 template<class ID> struct Entity
 {
   using type = typename ID::value_type;
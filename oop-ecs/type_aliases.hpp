@@ -7,7 +7,7 @@
 
 namespace ECS {
 
-template<class T> using ID_t = typename ECSMap_t<T>::Key_t;
+template<class T, class Index_t = std::size_t> using ID_t = MapKey_t<T, Index_t>;
 
 template<typename T>
 concept ComponentID = requires { typename T::value_type; } && !requires { typename T::value_type::Signature_t; };
@@ -15,30 +15,33 @@ concept ComponentID = requires { typename T::value_type; } && !requires { typena
 template<typename T>
 concept EntityID = requires { typename T::value_type::Signature_t; };
 
-template<class T> struct Handle_t
+// Index_t is the index type of the ECSMap_t the handle refers to, see
+// Config_t::Index_t.
+template<class T, class Index_t = std::size_t> struct Handle_t
 {
 private:
-  std::size_t mIndex{};
+  Index_t mIndex{};
 
 public:
-  using type = T;
+  using type       = T;
+  using index_type = Index_t;
 
-  template<class U, class = std::enable_if_t<!std::is_same_v<T, U>>> constexpr Handle_t(Handle_t<U>) = delete;
+  template<class U, class = std::enable_if_t<!std::is_same_v<T, U>>> constexpr Handle_t(Handle_t<U, Index_t>) = delete;
 
   constexpr Handle_t() = default;
 
-  constexpr Handle_t(std::size_t index)
+  constexpr Handle_t(index_type index)
     : mIndex{ index }
   {
   }
 
-  [[nodiscard]] constexpr auto GetIndex() const -> std::size_t { return mIndex; }
+  [[nodiscard]] constexpr auto GetIndex() const -> index_type { return mIndex; }
 
   template<class U> constexpr operator U() { return static_cast<U>(mIndex); }
 };
 
-template<ComponentID CID> Handle_t(CID) -> Handle_t<typename CID::value_type>;
+template<ComponentID CID> Handle_t(CID) -> Handle_t<typename CID::value_type, typename CID::index_type>;
 
-template<EntityID EID> Handle_t(EID) -> Handle_t<typename EID::value_type::Signature_t>;
+template<EntityID EID> Handle_t(EID) -> Handle_t<typename EID::value_type::Signature_t, typename EID::index_type>;
 
 } // namespace ECS
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "helpers.hpp"
+#include "snapshot.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <new>
+#include <span>
+
+#if defined(_WIN32)
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#elif __has_include(<sys/mman.h>)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace ECS {
+
+// Snapshot file mapped private and writable: its pages are read on first
+// touch and copied on first write, the file is never changed. A world mapped
+// from it with ECSManager_t::Map uses its columns in place, so the image must
+// outlive the world.
+// Without mmap or MapViewOfFile the file is read whole into aligned memory of
+// its own, the world still uses it in place.
+struct WorldImage_t final : Uncopyable_t
+{
+  WorldImage_t() = default;
+
+  ~WorldImage_t() { Close(); }
+
+#if defined(_WIN32)
+  auto Open(const char* path) -> bool
+  {
+    Close();
+    auto file{
+      ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr)
+    };
+    if (file == INVALID_HANDLE_VALUE) {
+      return false;
+    }
+    LARGE_INTEGER size{};
+    if (::GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+      // FILE_MAP_COPY is the copy on write of a private mapping
+      auto mapping{ ::CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr) };
+      if (mapping != nullptr) {
+        if (void* data{ ::MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0) }; data != nullptr) {
+          mBytes = { static_cast<std::byte*>(data), static_cast<std::size_t>(size.QuadPart) };
+        }
+        ::CloseHandle(mapping);
+      }
+    }
+    ::CloseHandle(file);
+    return !mBytes.empty();
+  }
+
+  auto Close() -> void
+  {
+    if (!mBytes.empty()) {
+      ::UnmapViewOfFile(mBytes.data());
+      mBytes = {};
+    }
+  }
+#elif __has_include(<sys/mman.h>)
+  auto Open(const char* path) -> bool
+  {
+    Close();
+    auto fd{ ::open(path, O_RDONLY) };
+    if (fd < 0) {
+      return false;
+    }
+    struct stat st
+    {};
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+      auto  size{ static_cast<std::size_t>(st.st_size) };
+      void* data{ ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) };
+      if (data != MAP_FAILED) {
+        mBytes = { static_cast<std::byte*>(data), size };
+      }
+    }
+    ::close(fd);
+    return !mBytes.empty();
+  }
+
+  auto Close() -> void
+  {
+    if (!mBytes.empty()) {
+      ::munmap(mBytes.data(), mBytes.size());
+      mBytes = {};
+    }
+  }
+#else
+  auto Open(const char* path) -> bool
+  {
+    Close();
+    auto* file{ std::fopen(path, "rb") };
+    if (file == nullptr) {
+      return false;
+    }
+    long size{};
+    if (std::fseek(file, 0, SEEK_END) == 0 && (size = std::ftell(file)) > 0 && std::fseek(file, 0, SEEK_SET) == 0) {
+      auto  count{ static_cast<std::size_t>(size) };
+      void* data{ ::operator new(count, std::align_val_t{ snapshot_alignment }, std::nothrow) };
+      if (data != nullptr) {
+        mBytes = { static_cast<std::byte*>(data), count };
+        if (std::fread(data, 1, count, file) != count) {
+          Close();
+        }
+      }
+    }
+    std::fclose(file);
+    return !mBytes.empty();
+  }
+
+  auto Close() -> void
+  {
+    if (!mBytes.empty()) {
+      ::operator delete(mBytes.data(), std::align_val_t{ snapshot_alignment });
+      mBytes = {};
+    }
+  }
+#endif
+
+  // aligned as an image reader needs
+  auto GetBytes() const -> std::span<std::byte> { return mBytes; }
+
+  auto GetReader() const -> ImageReader_t { return ImageReader_t{ mBytes }; }
+
+  // writes the bytes of a snapshot to the file an image is opened from
+  static auto Write(const char* path, std::span<const std::byte> bytes) -> bool
+  {
+    auto* file{ std::fopen(path, "wb") };
+    if (file == nullptr) {
+      return false;
+    }
+    auto written{ std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size() };
+    return std::fclose(file) == 0 && written;
+  }
+
+private:
+  std::span<std::byte> mBytes{};
+};
+
+} // namespace ECS
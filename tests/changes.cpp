@@ -0,0 +1,112 @@
+#include "tests.hpp"
+
+#include <class.hpp>
+#include <ecs_manager.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct PositionComponent_t
+{
+  static constexpr bool track_changes{ true };
+
+  float x{};
+};
+
+struct PhysicsComponent_t
+{
+  float vx{ 1.f };
+};
+
+struct RenderComponent_t
+{
+  char c{ 'r' };
+};
+
+struct Movable_t : ECS::Class_t<PositionComponent_t, PhysicsComponent_t>
+{};
+
+struct Renderable_t : ECS::Class_t<RenderComponent_t, PositionComponent_t>
+{};
+
+struct Character_t : ECS::Class_t<Movable_t, Renderable_t>
+{};
+
+template<class Store_t> struct Config_t
+{
+  using Signatures_t = TMPL::TypeList_t<Movable_t, Renderable_t, Character_t>;
+  using Storage_t    = Store_t;
+};
+
+template<class ECSMan_t> auto
+CountChanged(const ECSMan_t& ecs_man, ECS::Version_t since) -> std::size_t
+{
+  std::size_t count{};
+  ecs_man.template ForEachChanged<Movable_t, PositionComponent_t>(
+    since, [&](const PositionComponent_t&, const PhysicsComponent_t&) { ++count; });
+  return count;
+}
+
+template<class Storage_t> auto
+ConstAndMutable() -> void
+{
+  ECS::ECSManager_t<Config_t<Storage_t>> ecs_man{};
+  const auto&                            const_man{ ecs_man };
+  auto movs{ ecs_man.template CreateEntities<Movable_t>(
+    100, [](std::size_t i) { return std::tuple{ PositionComponent_t{ float(i) } }; }) };
+  auto chars{ ecs_man.template CreateEntities<Character_t>(
+    10, [](std::size_t i) { return std::tuple{ PositionComponent_t{ float(i) } }; }) };
+  Tests::Check(CountChanged(ecs_man, 0) == 110);
+
+  // reading records no change, whatever path it takes
+  auto since{ ecs_man.Tick() };
+  const_man.template ForEach<Movable_t>([](const PositionComponent_t&, const PhysicsComponent_t&) {});
+  const_man.template ForEach<Renderable_t>([](const RenderComponent_t&, const PositionComponent_t&) {});
+  for (auto e : movs) {
+    Tests::Check(const_man.template GetComponent<PositionComponent_t>(e).x >= 0.f);
+  }
+  Tests::Check(ecs_man.template DestroyIf<Movable_t>(
+                 [](const PositionComponent_t& pos, const PhysicsComponent_t&) { return pos.x < 0.f; }) == 0);
+  Tests::Check(CountChanged(ecs_man, since) == 0);
+
+  // handing out a component mutably records it, through a base too
+  for (std::size_t i{}; i < movs.size(); i += 10) {
+    ecs_man.template GetComponent<PositionComponent_t>(movs[i]).x += 1.f;
+  }
+  ecs_man.template GetComponent<PositionComponent_t>(ecs_man.template GetBaseID<Renderable_t>(chars[3])).x += 1.f;
+  std::vector<float> seen{};
+  const_man.template ForEachChanged<Movable_t, PositionComponent_t>(
+    since, [&](const PositionComponent_t& pos, const PhysicsComponent_t&, ECS::Handle_t<Movable_t>) {
+      seen.push_back(pos.x);
+    });
+  Tests::Check(seen.size() == 11);
+  std::size_t ren_changed{};
+  const_man.template ForEachChanged<Renderable_t, PositionComponent_t>(
+    since, [&](const RenderComponent_t&, const PositionComponent_t& pos) {
+      Tests::Check(pos.x == 4.f);
+      ++ren_changed;
+    });
+  Tests::Check(ren_changed == 1);
+
+  // a mutable traversal records every entity it visits, a new version none
+  since = ecs_man.Tick();
+  Tests::Check(CountChanged(ecs_man, since) == 0);
+  ecs_man.template ForEach<Movable_t>([](PositionComponent_t& pos, PhysicsComponent_t& phy) { pos.x += phy.vx; });
+  Tests::Check(CountChanged(ecs_man, since) == 110);
+
+  // an untracked component written does not count
+  since = ecs_man.Tick();
+  ecs_man.template GetComponent<PhysicsComponent_t>(movs[0]).vx = 2.f;
+  Tests::Check(CountChanged(ecs_man, since) == 0);
+}
+
+} // namespace
+
+auto
+Tests::Changes() -> void
+{
+  ConstAndMutable<ECS::SharedStorage_t>();
+  ConstAndMutable<ECS::ArchetypeStorage_t>();
+}
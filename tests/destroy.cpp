@@ -0,0 +1,148 @@
+#include "tests.hpp"
+
+#include <class.hpp>
+#include <ecs_manager.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+struct PositionComponent_t
+{
+  int x{};
+};
+
+struct PhysicsComponent_t
+{
+  int vx{ 1 };
+};
+
+struct RenderComponent_t
+{
+  char c{ 'r' };
+};
+
+struct Movable_t : ECS::Class_t<PositionComponent_t, PhysicsComponent_t>
+{};
+
+struct Renderable_t : ECS::Class_t<RenderComponent_t, PositionComponent_t>
+{};
+
+struct Character_t : ECS::Class_t<Movable_t, Renderable_t>
+{};
+
+template<class Store_t> struct Config_t
+{
+  using Signatures_t = TMPL::TypeList_t<Movable_t, Renderable_t, Character_t>;
+  using Storage_t    = Store_t;
+};
+
+template<class ECSMan_t> auto
+Positions(const ECSMan_t& ecs_man) -> std::vector<int>
+{
+  std::vector<int> xs{};
+  ecs_man.template ForEach<Movable_t>([&](const PositionComponent_t& pos, const PhysicsComponent_t&) {
+    xs.push_back(pos.x);
+  });
+  return xs;
+}
+
+// characters hold 0 to 99 and movables 100 to 199, every third of each is
+// destroyed through a span naming it twice, the characters by their base
+template<class Storage_t> auto
+DestroyRepeated(ECS::Compaction_t compaction) -> void
+{
+  ECS::ECSManager_t<Config_t<Storage_t>> ecs_man{};
+  auto chars{ ecs_man.template CreateEntities<Character_t>(
+    100, [](std::size_t i) { return std::tuple{ PositionComponent_t{ int(i) } }; }) };
+  auto movs{ ecs_man.template CreateEntities<Movable_t>(
+    100, [](std::size_t i) { return std::tuple{ PositionComponent_t{ 100 + int(i) } }; }) };
+  auto before{ Positions(ecs_man) };
+
+  std::vector<ECS::Handle_t<Movable_t>> victims{};
+  for (std::size_t i{}; i < 100; i += 3) {
+    victims.push_back(ecs_man.template GetBaseID<Movable_t>(chars[i]));
+    victims.push_back(movs[i]);
+  }
+  for (std::size_t i{}, count{ victims.size() }; i < count; ++i) {
+    victims.push_back(victims[i]);
+  }
+  ecs_man.template Destroy<Movable_t>(victims, compaction);
+
+  Tests::Check(ecs_man.template Size<Character_t>() == 66);
+  Tests::Check(ecs_man.template Size<Movable_t>() == 132);
+  Tests::Check(ecs_man.template Size<Renderable_t>() == 66);
+  for (std::size_t i{}; i < 100; ++i) {
+    if (i % 3 != 0) {
+      Tests::Check(ecs_man.template GetComponent<PositionComponent_t>(chars[i]).x == int(i));
+      Tests::Check(ecs_man.template GetComponent<PositionComponent_t>(movs[i]).x == 100 + int(i));
+    }
+  }
+  if (compaction == ECS::Compaction_t::Stable) {
+    std::vector<int> survivors{};
+    for (auto x : before) {
+      if (x % 100 % 3 != 0) {
+        survivors.push_back(x);
+      }
+    }
+    Tests::Check(Positions(ecs_man) == survivors);
+  }
+
+  // the slots freed are taken again by new entities
+  auto more{ ecs_man.template CreateEntities<Character_t>(
+    34, [](std::size_t i) { return std::tuple{ PositionComponent_t{ 200 + int(i) } }; }) };
+  Tests::Check(ecs_man.template Size<Character_t>() == 100);
+  for (std::size_t i{}; i < more.size(); ++i) {
+    Tests::Check(ecs_man.template GetComponent<PositionComponent_t>(more[i]).x == 200 + int(i));
+  }
+}
+
+template<class Storage_t> auto
+DestroyIfOdd(ECS::Compaction_t compaction) -> void
+{
+  ECS::ECSManager_t<Config_t<Storage_t>> ecs_man{};
+  ecs_man.template CreateEntities<Character_t>(
+    50, [](std::size_t i) { return std::tuple{ PositionComponent_t{ int(i) } }; });
+  ecs_man.template CreateEntities<Movable_t>(
+    50, [](std::size_t i) { return std::tuple{ PositionComponent_t{ 50 + int(i) } }; });
+  auto before{ Positions(ecs_man) };
+
+  auto count{ ecs_man.template DestroyIf<Movable_t>(
+    [](const PositionComponent_t& pos, const PhysicsComponent_t&) { return pos.x % 2 != 0; }, compaction) };
+  Tests::Check(count == 50);
+  Tests::Check(ecs_man.template Size<Character_t>() == 25);
+  Tests::Check(ecs_man.template Size<Renderable_t>() == 25);
+
+  std::vector<int> survivors{};
+  for (auto x : before) {
+    if (x % 2 == 0) {
+      survivors.push_back(x);
+    }
+  }
+  auto after{ Positions(ecs_man) };
+  if (compaction == ECS::Compaction_t::Stable) {
+    Tests::Check(after == survivors);
+  } else {
+    std::ranges::sort(after);
+    std::ranges::sort(survivors);
+    Tests::Check(after == survivors);
+  }
+
+  Tests::Check(ecs_man.template DestroyIf<Renderable_t>([](ECS::Handle_t<Renderable_t>) { return true; }) == 25);
+  Tests::Check(ecs_man.template Size<Character_t>() == 0);
+  Tests::Check(ecs_man.template Size<Movable_t>() == 25);
+}
+
+} // namespace
+
+auto
+Tests::Destroy() -> void
+{
+  for (auto compaction : { ECS::Compaction_t::Stable, ECS::Compaction_t::Unstable }) {
+    DestroyRepeated<ECS::SharedStorage_t>(compaction);
+    DestroyRepeated<ECS::ArchetypeStorage_t>(compaction);
+    DestroyIfOdd<ECS::SharedStorage_t>(compaction);
+    DestroyIfOdd<ECS::ArchetypeStorage_t>(compaction);
+  }
+}
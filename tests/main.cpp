@@ -0,0 +1,15 @@
+#include "tests.hpp"
+
+auto
+main() -> int
+{
+  Tests::Changes();
+  Tests::Defragment();
+  Tests::Destroy();
+  Tests::Query();
+  Tests::Scheduler();
+  Tests::Snapshot();
+
+  std::printf("%s\n", Tests::Failures == 0 ? "all checks passed" : "some checks failed");
+  return Tests::Failures == 0 ? 0 : 1;
+}
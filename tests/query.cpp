@@ -0,0 +1,130 @@
+#include "tests.hpp"
+
+#include <class.hpp>
+#include <ecs_manager.hpp>
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct PositionComponent_t
+{
+  int x{};
+};
+
+struct PhysicsComponent_t
+{
+  int vx{ 1 };
+};
+
+struct RenderComponent_t
+{
+  char c{ 'r' };
+};
+
+struct FrozenTag_t
+{};
+
+struct Movable_t : ECS::Class_t<PositionComponent_t, PhysicsComponent_t>
+{};
+
+struct Renderable_t : ECS::Class_t<RenderComponent_t, PositionComponent_t>
+{};
+
+struct Character_t : ECS::Class_t<Movable_t, Renderable_t>
+{};
+
+template<class Store_t, class BaseStore_t> struct Config_t
+{
+  using Signatures_t   = TMPL::TypeList_t<Movable_t, Renderable_t, Character_t>;
+  using Storage_t      = Store_t;
+  using BaseStorage_t  = BaseStore_t;
+  using OptionalTags_t = TMPL::TypeList_t<FrozenTag_t>;
+};
+
+// the sorted positions visited, the position comes first and the handle
+// given last is checked against it
+template<class... Cmps_t, class ECSMan_t> auto
+Visit(ECSMan_t& ecs_man) -> std::vector<int>
+{
+  std::vector<int> xs{};
+  ecs_man.template ForEachWith<Cmps_t...>([&](const PositionComponent_t& pos, const auto&... rest) {
+    auto e{ std::get<sizeof...(rest) - 1>(std::tie(rest...)) };
+    Tests::Check(ecs_man.template GetComponent<PositionComponent_t>(e).x == pos.x);
+    xs.push_back(pos.x);
+  });
+  std::ranges::sort(xs);
+  return xs;
+}
+
+auto
+Range(int first, int last, auto skip) -> std::vector<int>
+{
+  std::vector<int> xs{};
+  for (auto x{ first }; x < last; ++x) {
+    if (!skip(x)) {
+      xs.push_back(x);
+    }
+  }
+  return xs;
+}
+
+// movables hold 0 to 29, renderables 100 to 129 and characters 200 to 229,
+// every fifth of each is frozen, the characters through a base
+template<class Store_t, class BaseStore_t> auto
+Filters() -> void
+{
+  ECS::ECSManager_t<Config_t<Store_t, BaseStore_t>> ecs_man{};
+  auto movs{ ecs_man.template CreateEntities<Movable_t>(
+    30, [](std::size_t i) { return std::tuple{ PositionComponent_t{ int(i) } }; }) };
+  auto rens{ ecs_man.template CreateEntities<Renderable_t>(
+    30, [](std::size_t i) { return std::tuple{ PositionComponent_t{ 100 + int(i) } }; }) };
+  auto chars{ ecs_man.template CreateEntities<Character_t>(
+    30, [](std::size_t i) { return std::tuple{ PositionComponent_t{ 200 + int(i) } }; }) };
+  for (std::size_t i{}; i < 30; i += 5) {
+    ecs_man.template AddTag<FrozenTag_t>(movs[i]);
+    ecs_man.template AddTag<FrozenTag_t>(rens[i]);
+    ecs_man.template AddTag<FrozenTag_t>(ecs_man.template GetBaseID<Renderable_t>(chars[i]));
+  }
+  auto none{ [](int) { return false; } };
+  auto frozen{ [](int x) { return x % 100 % 5 == 0; } };
+  auto moving{ [](int x) { return x >= 100 && x < 200; } };
+
+  // every entity once, from its concrete signature
+  Tests::Check(Visit<PositionComponent_t>(ecs_man) == Range(0, 230, [](int x) { return x % 100 >= 30; }));
+  Tests::Check(Visit<PositionComponent_t, PhysicsComponent_t>(ecs_man) ==
+               Range(0, 230, [&](int x) { return x % 100 >= 30 || moving(x); }));
+  // a component filtered out leaves out whole signatures
+  Tests::Check(Visit<PositionComponent_t, ECS::Without_t<RenderComponent_t>>(ecs_man) ==
+               Range(0, 30, none));
+  // an optional tag filtered out leaves out the entities carrying it
+  Tests::Check(Visit<PositionComponent_t, ECS::Without_t<FrozenTag_t>>(std::as_const(ecs_man)) ==
+               Range(0, 230, [&](int x) { return x % 100 >= 30 || frozen(x); }));
+  Tests::Check(Visit<PositionComponent_t, ECS::Without_t<RenderComponent_t, FrozenTag_t>>(ecs_man) ==
+               Range(0, 30, frozen));
+  Tests::Check(Visit<PositionComponent_t, PhysicsComponent_t, ECS::Without_t<FrozenTag_t>>(ecs_man) ==
+               Range(0, 230, [&](int x) { return x % 100 >= 30 || moving(x) || frozen(x); }));
+
+  // the tag follows its entity when removed or transformed
+  ecs_man.template RemoveTag<FrozenTag_t>(movs[0]);
+  auto moved{ ecs_man.template TransformTo<Character_t>(movs[5]) };
+  Tests::Check(ecs_man.template HasTag<FrozenTag_t>(moved));
+  auto thawed{ Visit<PositionComponent_t, ECS::Without_t<FrozenTag_t>>(ecs_man) };
+  Tests::Check(std::ranges::binary_search(thawed, 0) && !std::ranges::binary_search(thawed, 5));
+  auto rendered{ Visit<PositionComponent_t, RenderComponent_t>(ecs_man) };
+  Tests::Check(!std::ranges::binary_search(rendered, 0) && std::ranges::binary_search(rendered, 5));
+}
+
+} // namespace
+
+auto
+Tests::Query() -> void
+{
+  Filters<ECS::SharedStorage_t, ECS::MaterializedBases_t>();
+  Filters<ECS::SharedStorage_t, ECS::VirtualBases_t>();
+  Filters<ECS::ArchetypeStorage_t, ECS::MaterializedBases_t>();
+  Filters<ECS::ArchetypeStorage_t, ECS::VirtualBases_t>();
+}
@@ -0,0 +1,107 @@
+#include "tests.hpp"
+
+#include <class.hpp>
+#include <ecs_manager.hpp>
+#include <scheduler.hpp>
+
+#include <array>
+#include <utility>
+
+namespace {
+
+struct PositionComponent_t
+{
+  float x{};
+};
+
+struct PhysicsComponent_t
+{
+  static constexpr bool track_changes{ true };
+
+  float vx{ 1.f };
+};
+
+struct HealthComponent_t
+{
+  int hp{ 10 };
+};
+
+struct VisibleTag_t
+{};
+
+struct Movable_t : ECS::Class_t<PositionComponent_t, PhysicsComponent_t, HealthComponent_t, VisibleTag_t>
+{};
+
+struct Config_t
+{
+  using Signatures_t = TMPL::TypeList_t<Movable_t>;
+};
+
+using ECSManager_t = ECS::ECSManager_t<Config_t>;
+
+} // namespace
+
+auto
+Tests::Scheduler() -> void
+{
+  auto read_all{ ECS::MakeSystem<Movable_t>(
+    [](const PositionComponent_t&, const PhysicsComponent_t&, const HealthComponent_t&, const VisibleTag_t&) {},
+    "read_all") };
+  auto read_by_value{ ECS::MakeSystem<Movable_t>(
+    [](PositionComponent_t, const PhysicsComponent_t&, const auto&, auto&) {}, "read_by_value") };
+  auto move{ ECS::MakeSystem<Movable_t>(
+    [](PositionComponent_t& pos, const PhysicsComponent_t& phy, const HealthComponent_t&, const VisibleTag_t&) {
+      pos.x += phy.vx;
+    },
+    "move") };
+  auto accelerate{ ECS::MakeSystem<Movable_t>(
+    [](const PositionComponent_t&, PhysicsComponent_t& phy, const HealthComponent_t&, const VisibleTag_t&, auto) {
+      phy.vx += 1.f;
+    },
+    "accelerate") };
+  auto heal{ ECS::MakeSystem<Movable_t, ECS::Read_t<>, ECS::Write_t<HealthComponent_t>>(
+    [](ECS::Handle_t<Movable_t>) {}, "heal") };
+  auto by_handle{ ECS::MakeSystem<Movable_t, ECS::Read_t<PositionComponent_t, PhysicsComponent_t, HealthComponent_t>>(
+    [](ECS::Handle_t<Movable_t>) {}, "by_handle") };
+
+  // the access comes from the constness of the parameters
+  static_assert(ECS::Seq::Size_v<decltype(read_all)::writes_type> == 0);
+  static_assert(ECS::Seq::Size_v<decltype(read_by_value)::writes_type> == 0);
+  static_assert(std::is_same_v<decltype(move)::writes_type, TMPL::TypeList_t<PositionComponent_t>>);
+  static_assert(std::is_same_v<decltype(accelerate)::writes_type, TMPL::TypeList_t<PhysicsComponent_t>>);
+  static_assert(std::is_same_v<decltype(heal)::writes_type, TMPL::TypeList_t<HealthComponent_t>>);
+  static_assert(ECS::Seq::Size_v<decltype(by_handle)::writes_type> == 0);
+
+  // the readers share the first wave, each writer waits for the last earlier
+  // system accessing what it writes and by_handle for the last writer
+  ECS::Scheduler_t scheduler{ read_all, read_by_value, move, accelerate, heal, by_handle };
+  constexpr std::array<std::size_t, 6> expected{ 0, 0, 1, 2, 3, 4 };
+  for (std::size_t i{}; i < expected.size(); ++i) {
+    Tests::Check(decltype(scheduler)::waves[i] == expected[i]);
+  }
+
+  ECSManager_t ecs_man{};
+  for (int i{}; i < 100; ++i) {
+    ecs_man.CreateEntity<Movable_t>();
+  }
+  auto since{ ecs_man.Tick() };
+  scheduler.Run(ecs_man);
+  float sum{};
+  std::as_const(ecs_man).ForEach<Movable_t>(
+    [&](const PositionComponent_t& pos, const PhysicsComponent_t& phy, const HealthComponent_t&, const VisibleTag_t&) {
+      Tests::Check(phy.vx == 2.f);
+      sum += pos.x;
+    });
+  Tests::Check(sum == 100.f);
+  std::size_t changed{};
+  ecs_man.ForEachChanged<Movable_t, PhysicsComponent_t>(since, [&](auto&&...) { ++changed; });
+  Tests::Check(changed == 100);
+
+  // systems writing nothing traverse the world const and record no change
+  since = ecs_man.Tick();
+  ECS::Scheduler_t readers{ read_all, read_by_value, by_handle };
+  readers.Run(ecs_man);
+  changed = 0;
+  ecs_man.ForEachChanged<Movable_t, PhysicsComponent_t>(since, [&](auto&&...) { ++changed; });
+  Tests::Check(changed == 0);
+}
@@ -0,0 +1,213 @@
+#include "tests.hpp"
+
+#include <class.hpp>
+#include <ecs_manager.hpp>
+#include <world_image.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+struct PositionComponent_t
+{
+  static constexpr bool track_changes{ true };
+
+  float x{};
+};
+
+struct PhysicsComponent_t
+{
+  float vx{ 1.f };
+};
+
+struct NameComponent_t
+{
+  std::string name{};
+};
+
+struct SelectedTag_t
+{};
+
+} // namespace
+
+template<> struct ECS::SnapshotCodec<NameComponent_t>
+{
+  static auto Write(SnapshotWriter_t& out, const NameComponent_t& cmp) -> void
+  {
+    out.Write(static_cast<std::uint32_t>(cmp.name.size()));
+    out.WriteBytes(cmp.name.data(), cmp.name.size());
+  }
+
+  static auto Read(SnapshotReader_t& in) -> NameComponent_t
+  {
+    auto            size{ in.Read<std::uint32_t>() };
+    NameComponent_t cmp{};
+    if (size > in.Remaining()) {
+      in.Fail();
+      return cmp;
+    }
+    cmp.name.resize(size);
+    in.ReadBytes(cmp.name.data(), size);
+    return cmp;
+  }
+};
+
+namespace {
+
+struct Movable_t : ECS::Class_t<PositionComponent_t, PhysicsComponent_t>
+{};
+
+struct Named_t : ECS::Class_t<NameComponent_t, PositionComponent_t>
+{};
+
+struct Character_t : ECS::Class_t<Movable_t, Named_t>
+{};
+
+template<class Store_t, class BaseStore_t> struct Config_t
+{
+  using Signatures_t   = TMPL::TypeList_t<Movable_t, Named_t, Character_t>;
+  using Storage_t      = Store_t;
+  using BaseStorage_t  = BaseStore_t;
+  using OptionalTags_t = TMPL::TypeList_t<SelectedTag_t>;
+};
+
+// the same signatures without the optional tag
+struct OtherConfig_t
+{
+  using Signatures_t = TMPL::TypeList_t<Movable_t, Named_t, Character_t>;
+};
+
+template<class ECSMan_t> auto
+Dump(const ECSMan_t& ecs_man) -> std::string
+{
+  std::string dump{};
+  ecs_man.template ForEach<Movable_t>(
+    [&](const PositionComponent_t& pos, const PhysicsComponent_t& phy, ECS::Handle_t<Movable_t> e) {
+      dump += std::to_string(e.GetIndex()) + ':' + std::to_string(pos.x) + ',' + std::to_string(phy.vx);
+      dump += ecs_man.template HasTag<SelectedTag_t>(e) ? "s;" : ";";
+    });
+  ecs_man.template ForEach<Named_t>(
+    [&](const NameComponent_t& cmp, const PositionComponent_t&, ECS::Handle_t<Named_t> e) {
+      dump += std::to_string(e.GetIndex()) + ':' + cmp.name + ';';
+    });
+  return dump;
+}
+
+// a world with holes in every container, a transformed entity and tags
+template<class ECSMan_t> auto
+Populate(ECSMan_t& ecs_man) -> void
+{
+  auto movs{ ecs_man.template CreateEntities<Movable_t>(
+    500, [](std::size_t i) { return std::tuple{ PositionComponent_t{ float(i) } }; }) };
+  std::vector<ECS::Handle_t<Character_t>> chars{};
+  for (int i{}; i < 50; ++i) {
+    chars.push_back(ecs_man.template CreateEntity<Character_t>(NameComponent_t{ "c" + std::to_string(i) }));
+  }
+  for (std::size_t i{}; i < movs.size(); i += 7) {
+    ecs_man.Destroy(movs[i]);
+  }
+  for (std::size_t i{}; i < chars.size(); i += 5) {
+    ecs_man.Destroy(chars[i]);
+  }
+  for (std::size_t i{ 1 }; i < chars.size(); i += 3) {
+    ecs_man.template AddTag<SelectedTag_t>(chars[i]);
+  }
+  ecs_man.template TransformTo<Character_t>(movs[1]);
+  ecs_man.Tick();
+}
+
+// the magic, the format version and the fingerprint of the signatures
+constexpr std::size_t header_size{ 16 };
+
+template<class Store_t, class BaseStore_t> auto
+RoundTrip() -> void
+{
+  using ECSManager_t = ECS::ECSManager_t<Config_t<Store_t, BaseStore_t>>;
+  ECSManager_t saved{};
+  Populate(saved);
+  ECS::SnapshotWriter_t out{};
+  saved.Save(out);
+  auto bytes{ out.Release() };
+
+  // loading replaces what the world held
+  ECSManager_t loaded{};
+  loaded.template CreateEntity<Movable_t>();
+  ECS::SnapshotReader_t in{ bytes };
+  Tests::Check(loaded.Load(in) && in.Remaining() == 0);
+  Tests::Check(Dump(loaded) == Dump(saved));
+  Tests::Check(loaded.Version() == saved.Version());
+  // the free slots come back in the same order
+  auto loaded_char{ loaded.template CreateEntity<Character_t>() };
+  Tests::Check(loaded_char.GetIndex() == saved.template CreateEntity<Character_t>().GetIndex());
+  auto loaded_mov{ loaded.template CreateEntity<Movable_t>() };
+  Tests::Check(loaded_mov.GetIndex() == saved.template CreateEntity<Movable_t>().GetIndex());
+  Tests::Check(Dump(loaded) == Dump(saved));
+
+  std::error_code ec{};
+  const auto      path{ (std::filesystem::temp_directory_path(ec) / "oop_ecs_tests_world.img").string() };
+  Tests::Check(ECS::WorldImage_t::Write(path.c_str(), bytes));
+  {
+    ECS::WorldImage_t image{};
+    Tests::Check(image.Open(path.c_str()));
+    ECSManager_t mapped{};
+    auto         image_in{ image.GetReader() };
+    Tests::Check(mapped.Map(image_in) && image_in.Remaining() == 0);
+
+    ECSManager_t copied{};
+    in = ECS::SnapshotReader_t{ bytes };
+    Tests::Check(copied.Load(in));
+    Tests::Check(Dump(mapped) == Dump(copied));
+    // a mapped world changes and grows as a loaded one
+    for (auto* ecs_man : { &mapped, &copied }) {
+      ecs_man->template ForEach<Movable_t>([](PositionComponent_t& pos, PhysicsComponent_t&) { pos.x += 1.f; });
+      ecs_man->template CreateEntities<Movable_t>(
+        300, [](std::size_t i) { return std::tuple{ PositionComponent_t{ float(i) } }; });
+      ecs_man->template CreateEntity<Character_t>(NameComponent_t{ "new" });
+    }
+    Tests::Check(Dump(mapped) == Dump(copied));
+
+    // the header of the image is checked before anything is borrowed, the
+    // bytes are a private copy of the file
+    for (std::size_t i{}; i < header_size; i += 4) {
+      auto image_bytes{ image.GetBytes() };
+      image_bytes[i] ^= std::byte{ 0x20 };
+      ECSManager_t rejected{};
+      auto         bad_in{ image.GetReader() };
+      Tests::Check(!rejected.Map(bad_in) && rejected.SizeAll() == 0);
+      image_bytes[i] ^= std::byte{ 0x20 };
+    }
+  }
+  std::remove(path.c_str());
+
+  // a corrupted header or a cut snapshot fails and leaves the world empty
+  for (std::size_t i{}; i < header_size; i += 4) {
+    auto corrupted{ bytes };
+    corrupted[i] ^= std::byte{ 0x20 };
+    ECS::SnapshotReader_t bad_in{ corrupted };
+    Tests::Check(!loaded.Load(bad_in) && loaded.SizeAll() == 0);
+  }
+  for (auto size : { std::size_t{}, header_size - 1, bytes.size() / 2, bytes.size() - 1 }) {
+    ECS::SnapshotReader_t cut_in{ std::span{ bytes }.first(size) };
+    Tests::Check(!loaded.Load(cut_in) && loaded.SizeAll() == 0);
+  }
+  // a world of other signatures tells by the fingerprint
+  ECS::ECSManager_t<OtherConfig_t> other{};
+  in = ECS::SnapshotReader_t{ bytes };
+  Tests::Check(!other.Load(in) && other.SizeAll() == 0);
+}
+
+} // namespace
+
+auto
+Tests::Snapshot() -> void
+{
+  RoundTrip<ECS::SharedStorage_t, ECS::MaterializedBases_t>();
+  RoundTrip<ECS::ArchetypeStorage_t, ECS::MaterializedBases_t>();
+  RoundTrip<ECS::SharedStorage_t, ECS::VirtualBases_t>();
+  RoundTrip<ECS::ArchetypeStorage_t, ECS::VirtualBases_t>();
+}
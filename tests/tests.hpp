@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdio>
+#include <source_location>
+
+// Checks stay on in release builds: a failed one is reported and counted and
+// the run goes on, main returns whether any failed.
+namespace Tests {
+
+inline int Failures{};
+
+inline auto
+Check(bool ok, std::source_location loc = std::source_location::current()) -> void
+{
+  if (!ok) {
+    ++Failures;
+    std::fprintf(stderr, "%s:%u: check failed in %s\n", loc.file_name(), loc.line(), loc.function_name());
+  }
+}
+
+auto Changes() -> void;
+auto Defragment() -> void;
+auto Destroy() -> void;
+auto Query() -> void;
+auto Scheduler() -> void;
+auto Snapshot() -> void;
+
+} // namespace Tests